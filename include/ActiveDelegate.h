@@ -1,13 +1,15 @@
 #ifndef CFIELDDELEGATE_H
 #define CFIELDDELEGATE_H
 
+#include "CellAtlas.h"
 #include "Constants.h"
 #include "GameField.h"
+#include "TableState.h"
 
 #include <QAbstractItemDelegate>
 #include <QApplication>
 #include <QModelIndex>
-#include <QStylePainter>
+#include <QPainter>
 
 namespace SPR
 {
@@ -22,10 +24,9 @@ namespace SPR
 		virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 		virtual QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 
-	  protected:
-		virtual void getStyleForField(const GameField &field, QStyleOptionButton &buttonStyle) const;
-		virtual void getGeneralsForField(const GameField &field, const QStyleOptionViewItem &option, QStyleOptionButton &buttonStyle) const;
+		virtual CellSprite spriteForField(const GameField &field) const;
 
+	  protected:
 		int m_fieldSize;
 	};
 
@@ -0,0 +1,111 @@
+#ifndef BOARDCORPUS_H
+#define BOARDCORPUS_H
+
+#include "Constants.h"
+#include "GameField.h"
+#include "MineSweeper.h"
+
+#include <QFile>
+#include <QPoint>
+#include <QRect>
+#include <QSaveFile>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+namespace SPR
+{
+
+	// Many boards in one file, for benchmarks and bot training. The file header is followed
+	// by the boards, each a fixed 32-byte header and a mine bitmap padded to 8 bytes, and
+	// ends with a table of board offsets. Everything is little-endian and 8-byte aligned,
+	// so a mapped file is read in place: finding board i is one index lookup, and loading
+	// it touches only that board's bytes.
+	class BoardCorpus
+	{
+	  public:
+		static constexpr quint32 MAGIC = 0x44534243;	// "DSBC"
+		static constexpr quint16 VERSION = 1;
+
+		enum Difficulty : quint8
+		{
+			Beginner,		 //  9 x  9, 10 mines
+			Intermediate,	 // 16 x 16, 40 mines
+			Expert,			 // 30 x 16, 99 mines
+			Custom
+		};
+
+		struct FileHeader
+		{
+			quint32_le magic;
+			quint16_le version;
+			quint16_le reserved;
+			quint64_le count;
+			quint64_le indexOffset;
+		};
+
+		struct BoardHeader
+		{
+			qint32_le width;
+			qint32_le height;
+			qint32_le mines;
+			quint32_le seed;
+			qint32_le threeBV;
+			qint32_le firstX;	 // (-1, -1) for boards not generated from the seed
+			qint32_le firstY;
+			quint8 difficulty;
+			quint8 reserved[3];
+		};
+
+		BoardCorpus();
+		~BoardCorpus();
+
+		bool open(const QString &filepath, QString *error = nullptr);
+		void close();
+		bool isOpen() const;
+
+		qint64 count() const;
+		// nullptr when index is out of range or the entry points outside the file
+		const BoardHeader *header(qint64 index) const;
+		bool load(qint64 index, MineSweeper &board) const;
+
+		static Difficulty difficultyOf(int width, int height, int mines);
+		static qint64 bitmapBytes(qint64 cells);
+
+	  private:
+		static bool fail(QString *error, const QString &message);
+
+		QFile m_file;
+		const uchar *m_data;
+		qint64 m_size;
+		qint64 m_count;
+		const quint64_le *m_index;
+	};
+
+	// Writes a corpus one board at a time; only the offset table is kept in memory
+	class BoardCorpusWriter
+	{
+	  public:
+		explicit BoardCorpusWriter(const QString &filepath);
+
+		bool open();
+		bool append(const MineSweeper &board);
+		// Writes the offset table and the file header, then replaces the target file
+		bool commit();
+		void cancel();
+
+		qint64 count() const;
+
+	  private:
+		QSaveFile m_file;
+		QVector< quint64 > m_offsets;
+		QByteArray m_record;
+	};
+
+	static_assert(sizeof(BoardCorpus::FileHeader) == 24);
+	static_assert(sizeof(BoardCorpus::BoardHeader) == 32);
+
+}	 // namespace SPR
+
+#endif	  // BOARDCORPUS_H
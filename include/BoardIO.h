@@ -0,0 +1,55 @@
+#ifndef BOARDIO_H
+#define BOARDIO_H
+
+#include "Constants.h"
+#include "GameField.h"
+#include "MineSweeper.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QSaveFile>
+#include <QString>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstring>
+
+namespace SPR
+{
+
+	// Boards in formats other tools use.
+	//
+	// Text: one line per row, '*' for a mine, '.' for a closed safe cell and a digit for an
+	// opened one. Files are mapped and parsed in place, row bands in parallel.
+	//
+	// MBF: width and height as one byte each, the mine count as a big-endian 16-bit
+	// value, then an (x, y) byte pair per mine. Boards are limited to 255 x 255.
+	class BoardIO
+	{
+	  public:
+		enum Format
+		{
+			Text,
+			Mbf
+		};
+
+		static Format formatFor(const QString &filepath);
+
+		static bool read(const QString &filepath, MineSweeper &board, QString *error = nullptr);
+		static bool write(const QString &filepath, const MineSweeper &board, QString *error = nullptr);
+
+		static bool parseText(const char *data, qint64 size, MineSweeper &board, QString *error = nullptr);
+		static bool writeText(QIODevice *device, const MineSweeper &board);
+
+		static bool readMbf(QIODevice *device, MineSweeper &board, QString *error = nullptr);
+		static bool writeMbf(QIODevice *device, const MineSweeper &board, QString *error = nullptr);
+
+	  private:
+		static bool fail(QString *error, const QString &message);
+	};
+
+}	 // namespace SPR
+
+#endif	  // BOARDIO_H
@@ -0,0 +1,63 @@
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include "ActiveDelegate.h"
+#include "CellAtlas.h"
+#include "Constants.h"
+#include "InactiveDelegate.h"
+#include "MineSweeper.h"
+#include "PngWriter.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SPR
+{
+
+	// Draws a board into a QImage without a widget, using the same sprites as the views.
+	// Construct it on the GUI thread (the sprite atlas comes from the application style);
+	// after that every method is const and may run on any thread. Rows follow the views:
+	// a row is the board's x, a column its y. Cell rects use x for column and y for row.
+	class BoardRenderer
+	{
+	  public:
+		BoardRenderer(const MineSweeper &board, bool gameOver, bool debug, int cellSize = FIELD_SIZE);
+
+		int cellSize() const;
+		int rowCount() const;
+		int columnCount() const;
+		QSize imageSize() const;
+
+		CellSprite spriteAt(int row, int column) const;
+		void renderCells(QImage &target, const QRect &cells, const QPoint &origin) const;
+
+		// Not thread-safe: keep the renderer's copy of the board in step with a live one
+		void updateCells(const MineSweeper &board, const QRect &cells);
+		void setGameOver(bool gameOver);
+
+		QImage render() const;
+		QImage render(const QRect &cells) const;
+
+		// Streams the whole board as PNG, rendering bands of rows no larger than bandBytes
+		bool exportPng(QIODevice *device, qint64 bandBytes = EXPORT_BAND_BYTES) const;
+		bool exportPng(const QString &filepath, qint64 bandBytes = EXPORT_BAND_BYTES) const;
+
+	  private:
+		void fillCell(QImage &target, const QPoint &topLeft, QRgb color) const;
+
+		MineSweeper m_board;
+		ActiveDelegate m_activeDelegate;
+		InactiveDelegate m_inactiveDelegate;
+		const ActiveDelegate *m_delegate;
+		const CellAtlas *m_atlas;
+		int m_cellSize;
+		bool m_debug;
+	};
+
+}	 // namespace SPR
+
+#endif	  // BOARDRENDERER_H
@@ -0,0 +1,131 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include "ActiveDelegate.h"
+#include "FrameStats.h"
+#include "InactiveDelegate.h"
+#include "LatencyTracker.h"
+#include "Move.h"
+#include "TableState.h"
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QScreen>
+#include <QScrollBar>
+#include <QTimer>
+#include <QVector>
+#include <QWheelEvent>
+#include <QtMath>
+#include <iterator>
+#include <utility>
+
+namespace SPR
+{
+
+	struct BoardTile
+	{
+		QPixmap pixmap;
+		QRect dirty;	// cells still to repaint, x is column and y is row
+	};
+
+	inline quint64 tileKey(int tileRow, int tileColumn)
+	{
+		return (quint64(quint32(tileRow)) << 32) | quint32(tileColumn);
+	}
+
+	// Board widget that reads cells straight from TableState and composes the viewport
+	// from cached tiles of about TILE_PIXELS device pixels a side, so the cache holds the
+	// same area at every zoom, repainting only cells reported as changed.
+	// Clicks are queued and handed to the model once per event-loop turn, in order and
+	// inside one TableState batch, so a burst of input costs one dataChanged and one repaint.
+	class BoardView : public QAbstractScrollArea
+	{
+		Q_OBJECT
+
+	  public:
+		BoardView(QWidget *parent = nullptr);
+
+		void setModel(TableState *model);
+		TableState *model() const;
+
+		QModelIndex indexAt(const QPoint &pos) const;
+		QRect visualRect(int row, int column) const;
+		QRect visibleCells() const;
+		virtual void adjustSizeToContents();
+		bool needsScrolling() const;
+		bool isActive() const;
+
+		int cellSize() const;
+		CellSprite spriteAt(int row, int column) const;
+		QRgb flatColorAt(int row, int column) const;
+		void centerOn(int row, int column);
+
+		void setFrameStats(FrameStats *stats);
+		void setLatencyTracker(LatencyTracker *latency);
+
+	  public slots:
+		void activate();
+		void deactivate();
+		void setCellSize(int cellSize);
+		void zoomIn();
+		void zoomOut();
+		void resetZoom();
+
+	  signals:
+		void pressed(const QModelIndex &index);
+		void clicked(const QModelIndex &index);
+		void rightClicked(const QModelIndex &index);
+		void bothClicked(const QModelIndex &index);
+		void middleClicked(const QModelIndex &index);
+		void zoomChanged(int cellSize);
+		void boardInvalidated();
+
+	  protected:
+		virtual void paintEvent(QPaintEvent *event) override;
+		virtual void mousePressEvent(QMouseEvent *event) override;
+		virtual void mouseReleaseEvent(QMouseEvent *event) override;
+		virtual void resizeEvent(QResizeEvent *event) override;
+		virtual void wheelEvent(QWheelEvent *event) override;
+		virtual void scrollContentsBy(int dx, int dy) override;
+
+	  private slots:
+		void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+		void onLayoutChanged();
+		void flushInput();
+
+	  private:
+		QSize contentSize() const;
+		void updateScrollBars();
+
+		int cellsPerTile() const;
+		QRect tileCells(int tileRow, int tileColumn) const;
+		int paintTile(QPainter *painter, int tileRow, int tileColumn);
+		int renderCells(QPixmap &pixmap, const QRect &cells, const QPoint &origin) const;
+		void invalidateTiles();
+		void queueInput(Move::Type type, const QModelIndex &index);
+
+		QStringList statsOverlayLines() const;
+		QRect statsOverlayRect() const;
+		void paintStatsOverlay(QPainter *painter) const;
+
+		TableState *m_model;
+		ActiveDelegate m_activeDelegate;
+		InactiveDelegate m_inactiveDelegate;
+		const ActiveDelegate *m_delegate;
+		QModelIndex m_pressedIndex;
+		QVector< Move > m_pendingInput;
+		bool m_inputScheduled;
+		QCache< quint64, BoardTile > m_tiles;
+		FrameStats *m_stats;
+		LatencyTracker *m_latency;
+		qreal m_tileRatio;
+		int m_cellSize;
+		bool m_active;
+		bool m_needsScrolling;
+	};
+
+}	 // namespace SPR
+
+#endif	  // BOARDVIEW_H
@@ -0,0 +1,103 @@
+#ifndef CELLATLAS_H
+#define CELLATLAS_H
+
+#include "Constants.h"
+
+#include <QApplication>
+#include <QIcon>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QStyle>
+#include <QStyleOptionButton>
+#include <QtMath>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace SPR
+{
+
+	// Every picture a cell can show. Order matters: Number1..Number8 are contiguous.
+	enum class CellSprite : quint8
+	{
+		Raised,
+		Sunken,
+		Number1,
+		Number2,
+		Number3,
+		Number4,
+		Number5,
+		Number6,
+		Number7,
+		Number8,
+		Flag,
+		Question,
+		Mine,
+		ExplodedMine,
+		WrongFlag,
+		Highlight,
+		Count
+	};
+
+	inline CellSprite numberSprite(int neighbours)
+	{
+		return static_cast< CellSprite >(static_cast< int >(CellSprite::Number1) + qBound(1, neighbours, 8) - 1);
+	}
+
+	// Single colour standing in for a sprite when cells are too small for artwork
+	inline QRgb flatColor(CellSprite sprite)
+	{
+		static const QRgb palette[] = {
+			0xffa8a8a8,	   // Raised
+			0xffdedede,	   // Sunken
+			0xff8080ff,	   // Number1
+			0xff80c080,	   // Number2
+			0xffff8080,	   // Number3
+			0xff8080c0,	   // Number4
+			0xffc08080,	   // Number5
+			0xff80c0c0,	   // Number6
+			0xff606060,	   // Number7
+			0xff909090,	   // Number8
+			0xffff9000,	   // Flag
+			0xffe0d040,	   // Question
+			0xffc02020,	   // Mine
+			0xff2040e0,	   // ExplodedMine
+			0xffff00ff,	   // WrongFlag
+			0xffe8e070,	   // Highlight
+		};
+		return palette[static_cast< int >(sprite)];
+	}
+
+	// All cell sprites pre-rendered once with the current style into a single strip,
+	// so painting a cell is one blit instead of a style call and a resource decode.
+	class CellAtlas
+	{
+	  public:
+		CellAtlas(int cellSize, qreal devicePixelRatio, QStyle *style);
+
+		int cellSize() const;
+		qreal devicePixelRatio() const;
+
+		const QImage &image() const;
+		const QPixmap &pixmap() const;
+		QRect sourceRect(CellSprite sprite) const;
+
+		void draw(QPainter *painter, const QRect &target, CellSprite sprite) const;
+
+		// GUI thread only: atlases are built with QApplication::style()
+		static const CellAtlas &shared(int cellSize, qreal devicePixelRatio);
+
+	  private:
+		void renderSprite(QPainter *painter, const QRect &rect, CellSprite sprite, QStyle *style) const;
+
+		int m_cellSize;
+		int m_physicalSize;
+		qreal m_devicePixelRatio;
+		QImage m_image;
+		QPixmap m_pixmap;
+	};
+
+}	 // namespace SPR
+
+#endif	  // CELLATLAS_H
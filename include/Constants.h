@@ -26,12 +26,27 @@ namespace SPR
 	const int FIELD_SIZE = 24;
 	const int ICON_SIZE = 16;
 
+	// Board view tiles, in device pixels per side, and the tile cache budget in KiB
+	const int TILE_PIXELS = 512;
+	const int TILE_CACHE_KB = 256 * 1024;
+	// Cells per side of one unit of work when rendering a whole board
+	const int TILE_CELLS = 64;
+
+	// Zoom, in pixels per cell. Cells smaller than LOD_CELL_SIZE are drawn as flat colour
+	const int ZOOM_LEVELS[] = { 1, 2, 4, 8, 12, 16, 24, 32, 48 };
+	const int LOD_CELL_SIZE = 16;
+
+	// Minimap side in pixels and samples per block side
+	const int MINIMAP_SIZE = 200;
+	const int MINIMAP_SAMPLES = 4;
+
 	// GUI constants
 	const int DEFAULT_WINDOW_WIDTH = 276;
 	const int DEFAULT_WINDOW_HEIGHT = 327;
 	const int MARGIN_SIZE = 11;
 	const int DEFAULT_SPACE = 3;
 	const int DOUBLE_SPACE = 6;
+	const int SCREEN_MARGIN = 160;
 
 	// TopWidget constants
 	const int MIN_WIDTH = 0;
@@ -73,6 +88,54 @@ namespace SPR
 	const int HIGHLIGHT_TIMEOUT = 300;
 	const int TWO_SEC_TIMEOUT = 2000;
 
+	// Frame statistics: frames kept, histogram buckets (1 ms each, last is overflow),
+	// event-loop probe interval and overlay refresh interval
+	const int STATS_HISTORY = 600;
+	const int STATS_BUCKETS = 33;
+	const int STATS_TICK = 16;
+	const int STATS_REFRESH = 500;
+
+	// Click latency log: a percentile summary line after this many samples
+	const int LATENCY_LOG_EVERY = 100;
+
+	// Reveal work per event-loop turn, and cells processed between budget checks
+	const int FRAME_BUDGET_MS = 8;
+	const int REVEAL_BATCH = 1024;
+
+	// Model batches: nearby changes are merged while their bounding rect adds at most
+	// BATCH_MERGE_SLACK unchanged cells; a batch keeps at most BATCH_REGIONS rects
+	const int BATCH_MERGE_SLACK = 64;
+	const int BATCH_REGIONS = 16;
+
+	// Upper bound for one rendered band while exporting a board image
+	const qint64 EXPORT_BAND_BYTES = 64 * 1024 * 1024;
+
+	// Save payload: planes are split into chunks of this size and compressed one per task
+	const int SAVE_CHUNK_BYTES = 1024 * 1024;
+	const int SAVE_COMPRESSION = 1;
+
+	// Largest board read from a file, in cells; anything bigger is treated as corrupt
+	const long long MAX_BOARD_CELLS = 256LL * 1024 * 1024;
+
+	// From this many cells saves keep raw cell records, loaded with a mapped bulk copy
+	const long long SAVE_RAW_CELLS = 16LL * 1024 * 1024;
+
+	// Save browser: longest thumbnail side in pixels
+	const int THUMBNAIL_SIZE = 64;
+
+	// Board import/export: cells handled per task or per write
+	const int BOARD_IO_BAND_CELLS = 1024 * 1024;
+
+	// Move journal: a full checkpoint after this many logged moves
+	const int JOURNAL_CHECKPOINT_MOVES = 200;
+
+	// Live session file: mapped pages reach the disk at most this long after a change
+	const int SESSION_FLUSH_MS = 50;
+
+	// Replay playlist: shortest and longest time a frame stays on screen
+	const int REPLAY_MIN_DELAY_MS = 40;
+	const int REPLAY_MAX_DELAY_MS = 1000;
+
 }	 // namespace SPR
 
 #endif	  // CONSTANTS
@@ -0,0 +1,69 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include "Constants.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+namespace SPR
+{
+
+	// Rolling paint and event-loop timings for the debug overlay. Views hold a pointer to it
+	// only while debug mode is on, so nothing is measured otherwise.
+	class FrameStats : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		explicit FrameStats(QObject *parent = nullptr);
+
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
+
+		void beginFrame();
+		void endFrame(int cellsPainted);
+		void addDataChanged(qint64 cells);
+
+		QStringList summary() const;
+		QVector< int > paintHistogram() const;
+		QVector< int > latencyHistogram() const;
+		bool dump(const QString &filepath) const;
+
+	  signals:
+		void updated();
+
+	  private slots:
+		void onTick();
+
+	  private:
+		struct Frame
+		{
+			int cells = 0;
+			int changes = 0;
+			qint64 changedCells = 0;
+		};
+
+		static QVector< int > histogram(const QVector< qint64 > &samplesNs, int count);
+
+		QVector< Frame > m_frames;
+		QVector< qint64 > m_paintNs;
+		QVector< qint64 > m_latencyNs;
+		int m_frameCount;
+		int m_latencyCount;
+		int m_pendingChanges;
+		qint64 m_pendingChangedCells;
+		QElapsedTimer m_paintTimer;
+		QElapsedTimer m_tickTimer;
+		QElapsedTimer m_refreshTimer;
+		QTimer m_ticker;
+	};
+
+}	 // namespace SPR
+
+#endif	  // FRAMESTATS_H
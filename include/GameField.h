@@ -1,6 +1,8 @@
 #ifndef SFIELD
 #define SFIELD
 
+#include "Constants.h"
+
 #include <QMetaType>
 
 namespace SPR
@@ -15,6 +17,16 @@ namespace SPR
 		bool isHighlighted = false;
 	};
 
+	// For cells copied in as raw bytes: false unless every value is one the game produces.
+	// The display-only members are cleared whatever the bytes held
+	inline bool sanitizeRaw(GameField &field)
+	{
+		field.isDebug = false;
+		field.isHighlighted = false;
+		return field.mine >= 0 && field.mine <= 1 && field.discovered >= FIELD_NOT_VISITED && field.discovered <= FIELD_VISITED &&
+			   field.disarmed >= FIELD_NOT_VISITED && field.disarmed <= PLAYER_NOT_SURE && field.neighbours >= 0 && field.neighbours <= 8;
+	}
+
 }	 // namespace SPR
 
 Q_DECLARE_METATYPE(SPR::GameField);
@@ -12,8 +12,7 @@ namespace SPR
 	  public:
 		InactiveDelegate(QObject *parent = nullptr);
 
-	  protected:
-		virtual void getStyleForField(const GameField &field, QStyleOptionButton &buttonStyle) const;
+		virtual CellSprite spriteForField(const GameField &field) const override;
 	};
 }	 // namespace SPR
 #endif	  // INACTIVEDELEGATE_H
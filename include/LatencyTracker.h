@@ -0,0 +1,69 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include "Constants.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+
+namespace SPR
+{
+
+	// Click-to-pixel latency: a mouse event in BoardView is followed through the TableState
+	// slot, the engine update and dataChanged to the first paint after it. Like FrameStats,
+	// the view and model hold a pointer to it only while debug mode is on.
+	class LatencyTracker : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		enum Stage
+		{
+			Event,
+			Slot,
+			Engine,
+			DataChanged,
+			Painted,
+			StageCount
+		};
+
+		explicit LatencyTracker(QObject *parent = nullptr);
+
+		void begin();
+		void mark(Stage stage);
+		void painted();
+
+		int sampleCount() const;
+		// Time from the input event until the stage was reached, over the recent samples
+		qint64 percentile(Stage stage, double fraction) const;
+		QStringList summary() const;
+
+		// Every sample is appended to the log as CSV, with a percentile line now and then
+		bool setLogFile(const QString &filepath);
+
+	  private:
+		struct Sample
+		{
+			qint64 at[StageCount] = {};
+		};
+
+		void writeSample(const Sample &sample);
+
+		QVector< Sample > m_samples;
+		Sample m_current;
+		int m_sampleCount;
+		bool m_active;
+		QElapsedTimer m_clock;
+		QFile m_log;
+	};
+
+}	 // namespace SPR
+
+#endif	  // LATENCYTRACKER_H
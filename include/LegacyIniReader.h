@@ -0,0 +1,44 @@
+#ifndef LEGACYINIREADER_H
+#define LEGACYINIREADER_H
+
+#include "GameField.h"
+#include "MineSweeper.h"
+#include "SaveFormat.h"
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <cstring>
+#include <limits>
+
+namespace SPR
+{
+
+	// Reads the INI saves QSettings used to write (a Cell_x_y group per cell) in one pass
+	// over the lines, without QSettings and its key tree. QSettings sorts sections, so
+	// [Board] comes before [Game]: cells are collected as small records and placed once
+	// the dimensions are known.
+	class LegacyIniReader
+	{
+	  public:
+		// With validate set, a safe cell whose neighbour count disagrees with the mines
+		// around it fails the read
+		static bool read(QIODevice *device, MineSweeper &board, SaveHeader &header, bool validate = true, QString *error = nullptr);
+
+	  private:
+		struct CellRecord
+		{
+			qint32 x = -1;
+			qint32 y = -1;
+			GameField field;
+		};
+
+		static bool parseCellKey(const char *key, int length, qint32 &x, qint32 &y, const char *&member);
+		static bool parseInt(const char *text, int length, qint32 &value);
+		static bool fail(QString *error, const QString &message);
+	};
+
+}	 // namespace SPR
+
+#endif	  // LEGACYINIREADER_H
@@ -3,11 +3,15 @@
 
 #include "Constants.h"
 #include "GameField.h"
+#include "Move.h"
 
+#include <QPoint>
+#include <QRandomGenerator>
+#include <QRect>
 #include <QVector>
 #include <QtCore>
-#include <cstdlib>
-#include <ctime>
+#include <deque>
+#include <vector>
 
 namespace SPR
 {
@@ -20,37 +24,88 @@ namespace SPR
 		int width() const;
 		int height() const;
 		long long size() const;
+		// Whether width x height is a board the game can hold, within MAX_BOARD_CELLS.
+		// Dimensions read from a file are checked with it before anything is allocated
+		static bool fitsBoard(qint64 width, qint64 height);
 
 		void reset(int width, int height, int mineNumber);
 		void populate(int xToSkip, int yToSkip);
 
+		// reset() draws a fresh seed; the same seed and first click give the same mines
+		void setSeed(quint32 seed);
+		quint32 seed() const;
+		bool isGenerated() const;
+		QPoint firstClick() const;
+		// For boards restored with their mines already placed: the click populate() was
+		// given, so the board counts as generated from its seed again
+		void setFirstClick(const QPoint &click);
+
 		int countFlagsAround(int x, int y) const;
 		int getNeighbours(int x, int y) const;
 		int getMine(int x, int y) const;
 		int getFlag(int x, int y) const;
 		bool getDiscovered(int x, int y) const;
 		int totalMineNr() const;
+		int discoveredCount() const;
+		// Fewest left clicks that clear the board: one per opening plus one per numbered cell
+		// no opening reaches
+		int threeBV() const;
 
 		void discover(int x, int y);
 		void disarm(int x, int y);
 		bool checkWinCondition() const;
 
+		// Flood fill, processed incrementally. changed grows to cover revealed cells (x, y)
+		void queueReveal(int x, int y);
+		bool queueChord(int x, int y);
+		int revealPending(int maxCells, QRect &changed);
+		bool hasPendingReveal() const;
+		bool mineRevealed() const;
+
+		// Applies a recorded move the way TableState would, reveals included; returns the
+		// changed cells (x, y)
+		QRect applyMove(const Move &move);
+
 		GameField& field(int x, int y);
 		const GameField& fieldConst(int x, int y) const;
 
+		// Row-major storage (index y * width + x) for bulk copies
+		GameField* cells();
+		const GameField* cells() const;
+
+		// Recounts discovered cells after they were written from outside, e.g. by a loader
+		void restoreCounters();
+		// Recomputes the mine total, neighbour counts and discovered count after mines were
+		// written straight into cells(), e.g. by an importer
+		void recountMines();
+		// First safe cell whose stored count disagrees with its mines, (-1, -1) if none
+		QPoint firstNeighbourMismatch() const;
+
 		void markTemporary(int x, int y);
 		void clearHighlights();
 
 	  private:
 		void populateMineCrew(int xToSkip, int yToSkip);
 		void populateNeighbourhood();
+		int minesAround(int x, int y) const;
 		bool isValidIndex(int x, int y) const;
 
 		int m_width;
 		int m_height;
 		int m_totalMineNr;
 		int m_discoveredFieldsNr;
+		bool m_mineRevealed;
+		quint32 m_seed;
+		QPoint m_firstClick;
 		QVector< GameField > m_data;
+		std::deque< int > m_revealQueue;
+	};
+
+	// A generated board as it stood when play began, and the moves made on it since
+	struct MoveLog
+	{
+		MineSweeper start;
+		QVector< Move > moves;
 	};
 
 }	 // namespace SPR
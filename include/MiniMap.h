@@ -0,0 +1,55 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "BoardView.h"
+#include "Constants.h"
+
+#include <QImage>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTimer>
+#include <QWidget>
+
+namespace SPR
+{
+
+	// Downsampled overview of the board. Each pixel stands for a block of cells and is
+	// recoloured only when cells inside that block change.
+	class MiniMap : public QWidget
+	{
+		Q_OBJECT
+
+	  public:
+		explicit MiniMap(QWidget *parent = nullptr);
+
+		void setView(BoardView *view);
+		virtual QSize sizeHint() const override;
+
+	  public slots:
+		void rebuild();
+		void scheduleRebuild();
+
+	  protected:
+		virtual void paintEvent(QPaintEvent *event) override;
+		virtual void mousePressEvent(QMouseEvent *event) override;
+		virtual void mouseMoveEvent(QMouseEvent *event) override;
+
+	  private slots:
+		void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+	  private:
+		void updateBlocks(const QRect &blocks);
+		QRgb blockColor(int blockRow, int blockColumn) const;
+		void centerViewAt(const QPoint &pos);
+
+		BoardView *m_view;
+		TableState *m_model;
+		QImage m_image;
+		int m_cellsPerPixel;
+		int m_pixelScale;
+		bool m_rebuildScheduled;
+	};
+
+}	 // namespace SPR
+
+#endif	  // MINIMAP_H
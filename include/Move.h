@@ -0,0 +1,49 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <QDataStream>
+#include <QMetaType>
+
+namespace SPR
+{
+	// One player action on a cell, as emitted by the board view
+	struct Move
+	{
+		enum Type : quint8
+		{
+			Reveal,
+			Flag,
+			Chord,
+			Middle
+		};
+
+		Type type = Reveal;
+		int row = 0;
+		int column = 0;
+		qint64 msec = 0;	// since the game started
+	};
+
+	inline QDataStream &operator<<(QDataStream &out, const Move &move)
+	{
+		return out << quint8(move.type) << qint32(move.row) << qint32(move.column) << qint64(move.msec);
+	}
+
+	inline QDataStream &operator>>(QDataStream &in, Move &move)
+	{
+		quint8 type = 0;
+		qint32 row = 0;
+		qint32 column = 0;
+		qint64 msec = 0;
+		in >> type >> row >> column >> msec;
+		move.type = static_cast< Move::Type >(type);
+		move.row = row;
+		move.column = column;
+		move.msec = msec;
+		return in;
+	}
+
+}	 // namespace SPR
+
+Q_DECLARE_METATYPE(SPR::Move);
+
+#endif	  // MOVE_H
@@ -0,0 +1,81 @@
+#ifndef MOVEJOURNAL_H
+#define MOVEJOURNAL_H
+
+#include "Constants.h"
+#include "MineSweeper.h"
+#include "Move.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QObject>
+#include <QRect>
+#include <QSaveFile>
+#include <QVector>
+#include <algorithm>
+#include <deque>
+#include <zlib.h>
+
+namespace SPR
+{
+
+	// Append-only log of the moves made since the last checkpoint (the quick save). Every
+	// entry carries a sequence number and a CRC, so a torn last write is found and dropped.
+	// A checkpoint stores the sequence it covers; once it is on disk the log is compacted
+	// to the entries after it. Persisting a move is one small write.
+	// The header holds the sequence the log started from, so a log begun for a new game is
+	// never replayed onto the checkpoint of an older one. Replaying an entry the board
+	// already holds changes nothing: flags are logged with the state they left.
+	class MoveJournal : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		static constexpr quint32 MAGIC = 0x44534D4A;	// "DSMJ"
+		static constexpr quint16 VERSION = 2;	 // 2: entries carry the flag state
+
+		explicit MoveJournal(const QString &filepath, QObject *parent = nullptr);
+
+		QString path() const;
+		qint64 sequence() const;
+
+		bool restart();
+		void discard();
+		// flag is the cell's state after a Flag move, -1 when not known
+		bool append(const Move &move, qint8 flag = -1);
+
+		// Checkpoints finish in the order they were begun
+		qint64 beginCheckpoint();
+		void endCheckpoint(bool ok);
+
+		// Applies the logged moves newer than the checkpoint, appending them to applied
+		// when given; returns how many
+		int replay(MineSweeper &board, qint64 checkpointSequence, QVector< Move > *applied = nullptr);
+
+	  signals:
+		void checkpointDue();
+
+	  private:
+		struct Entry
+		{
+			qint64 sequence = 0;
+			Move move;
+			qint8 flag = -1;
+		};
+
+		static QByteArray encode(const Entry &entry);
+		static void apply(MineSweeper &board, const Entry &entry);
+		bool rewrite();
+
+		QString m_path;
+		QFile m_file;
+		qint64 m_base;
+		qint64 m_sequence;
+		qint64 m_checkpointed;
+		std::deque< qint64 > m_pendingCheckpoints;
+		QVector< Entry > m_tail;
+	};
+
+}	 // namespace SPR
+
+#endif	  // MOVEJOURNAL_H
@@ -0,0 +1,50 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QImage>
+#include <QtEndian>
+#include <zlib.h>
+
+namespace SPR
+{
+
+	// Minimal streaming PNG encoder (8-bit RGB, no interlace). Rows are deflated as they
+	// arrive, so the whole image never has to exist in memory at once. Translucent pixels
+	// are flattened onto the background colour.
+	class PngWriter
+	{
+	  public:
+		explicit PngWriter(QIODevice *device, int compressionLevel = Z_DEFAULT_COMPRESSION);
+		~PngWriter();
+
+		PngWriter(const PngWriter &) = delete;
+		PngWriter &operator=(const PngWriter &) = delete;
+
+		bool begin(int width, int height);
+		bool writeRows(const QImage &rows);
+		bool finish();
+
+		void setBackground(QRgb color);
+		int rowsWritten() const;
+
+	  private:
+		bool writeChunk(const char *type, const QByteArray &data);
+		bool deflateInto(int flush);
+
+		QIODevice *m_device;
+		z_stream m_stream;
+		QByteArray m_row;
+		QByteArray m_out;
+		QRgb m_background;
+		int m_compressionLevel;
+		int m_width;
+		int m_height;
+		int m_rowsWritten;
+		bool m_open;
+	};
+
+}	 // namespace SPR
+
+#endif	  // PNGWRITER_H
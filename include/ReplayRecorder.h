@@ -0,0 +1,56 @@
+#ifndef REPLAYRECORDER_H
+#define REPLAYRECORDER_H
+
+#include "BoardView.h"
+#include "MineSweeper.h"
+#include "Move.h"
+#include "TableState.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+namespace SPR
+{
+
+	// Records the clicks a BoardView sends to its model, together with the board as it was
+	// when the game started, so the game can be played back later. Attach it after the
+	// model's own connections so the first click is recorded after gameStarted.
+	class ReplayRecorder : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		explicit ReplayRecorder(QObject *parent = nullptr);
+
+		void attach(BoardView *view, TableState *model);
+
+		bool isRecording() const;
+		const MineSweeper &startBoard() const;
+		const QVector< Move > &moves() const;
+		const MoveLog &log() const;
+
+		// Continues recording a loaded game: from the log it was saved with when that
+		// holds a generated board, otherwise from the current board
+		void resume(const MoveLog &log = MoveLog());
+
+	  signals:
+		void recorded(const Move &move);
+
+	  public slots:
+		void clear();
+		void record(Move::Type type, const QModelIndex &index);
+
+	  private:
+		void onGameStarted();
+
+		TableState *m_model;
+		MoveLog m_log;
+		QElapsedTimer m_clock;
+		qint64 m_offset;	// msec already played before a resume
+		bool m_recording;
+	};
+
+}	 // namespace SPR
+
+#endif	  // REPLAYRECORDER_H
@@ -0,0 +1,48 @@
+#ifndef REPLAYRENDERER_H
+#define REPLAYRENDERER_H
+
+#include "BoardRenderer.h"
+#include "Constants.h"
+#include "MineSweeper.h"
+#include "Move.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+namespace SPR
+{
+
+	// Turns a recorded game into numbered PNG frames, one for the start board and one per
+	// move. The game is replayed headlessly and only the cells a move changed are repainted
+	// onto a persistent framebuffer; frames are encoded on the global thread pool.
+	// A replay.ffconcat playlist carrying the move timing is written next to the frames.
+	class ReplayRenderer
+	{
+	  public:
+		ReplayRenderer(const MineSweeper &start, const QVector< Move > &moves, bool debug = false, int cellSize = FIELD_SIZE);
+
+		int frameCount() const;
+		static QString frameName(int number);
+
+		bool renderTo(const QString &directory);
+
+	  private:
+		void advance(MineSweeper &board, const Move &move);
+
+		MineSweeper m_start;
+		QVector< Move > m_moves;
+		BoardRenderer m_renderer;
+		QImage m_framebuffer;
+		bool m_gameOver;
+	};
+
+}	 // namespace SPR
+
+#endif	  // REPLAYRENDERER_H
@@ -1,49 +1,92 @@
 #ifndef SAVE_H
 #define SAVE_H
 
+#include "LegacyIniReader.h"
 #include "MineSweeper.h"
 #include "Preferences.h"
+#include "SaveBrowser.h"
+#include "SaveFormat.h"
+#include "SaveIndex.h"
+#include "SessionFile.h"
 #include "TopWidget.h"
 
+#include <QAtomicInt>
 #include <QCoreApplication>
 #include <QDataStream>
 #include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QObject>
+#include <QSaveFile>
 #include <QSettings>
 #include <QStandardPaths>
+#include <QThreadPool>
 #include <QTimer>
+#include <QtConcurrent>
+#include <functional>
 #include <memory>
 
 namespace FileFormat
 {
-	const QString QUICKSAVE_FILE = "quicksave.ini";
+	const QString SESSION_FILE = "session.dat";
+	// The INI quick save of older builds, offered until a session file exists
+	const QString LEGACY_QUICKSAVE_FILE = "quicksave.ini";
+	const QString JOURNAL_FILE = "quicksave.journal";
 }	 // namespace FileFormat
 
 namespace SPR
 {
+	// Saves snapshot the board (the cell buffer is shared until the game next writes to it)
+	// and are written on a single worker thread, in order, through QSaveFile: a temporary
+	// file that is synced and renamed over the target only once complete.
 	class Save : public QObject
 	{
 		Q_OBJECT
 
 	  public:
 		explicit Save(MineSweeper& model, QTimer& timer, Preferences& prefs, QObject* parent = nullptr);
+		~Save();
 
 		void setTopWidget(TopWidget* topWidget);
+		// With a move log set, generated boards are saved as seed and moves when that
+		// rebuilds them exactly; everything else is saved in full
+		void setMoveLog(const MoveLog* log);
+		const MoveLog& loadedLog() const;
 
 		bool saveGame();
 		bool loadGame();
 
-		bool quickSave();
+		// The quick save is the live session file: a sync copies only the cells marked
+		// changed, so it is cheap enough to run after every move
+		bool quickSave(qint64 journalSequence = 0);
+		// Asynchronous: quickSaveFlushed() follows once the last quickSave is on disk
+		void flushQuickSave();
 		bool quickLoad();
+		// Removes the session and the quick save an older build left, so nothing is offered
+		// for resuming
+		void discardQuickSave();
+		void markChanged(const QRect& cells);
+		void markAllChanged();
+		void syncTime();
 
 		static QString quickSavePath();
+		static QString journalPath();
+		qint64 loadedJournalSequence() const;
+
+		void saveAsync(const QString& filepath, qint64 journalSequence = 0);
+		bool isSaving() const;
+		void waitForSaves();
 
 		int getElapsedTime(const QString& filepath) const;
+		// Header only for binary saves, without touching the cells; INI saves are parsed whole
+		static bool readHeader(const QString& filepath, SaveHeader& header);
+		static bool verify(const QString& filepath);
 
 	  signals:
 		void restoreElapsed(int msec);
+		void saveProgress(const QString& filepath, int percent);
+		void saveFinished(const QString& filepath, bool ok);
+		void quickSaveFlushed(bool ok);
 
 	  private:
 		MineSweeper& _model;
@@ -51,9 +94,26 @@ namespace SPR
 		Preferences& _prefs;
 		QObject* _parent;
 		TopWidget* _topWidget;
+		QThreadPool m_writer;
+		QAtomicInt m_pendingSaves;
+		qint64 m_loadedSequence;
+		const MoveLog* m_moveLog;
+		MoveLog m_loadedLog;
+		SessionFile m_session;
+		std::unique_ptr< SaveIndex > m_index;	 // Documents folder, started by the first loadGame()
+
+		static bool writeFile(const QString& filepath,
+							  const MineSweeper& board,
+							  int elapsed,
+							  bool timerRunning,
+							  qint64 journalSequence = 0,
+							  const MoveLog& log = MoveLog(),
+							  const std::function< void(int) >& progress = nullptr);
 
 		bool serialize(const QString& filepath);
 		bool deserialize(const QString& filepath);
+		bool deserializeIni(const QString& filepath);
+		void applyLoaded(int width, int height, int mine, int elapsed);
 	};
 
 }	 // namespace SPR
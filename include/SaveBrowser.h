@@ -0,0 +1,47 @@
+#ifndef SAVEBROWSER_H
+#define SAVEBROWSER_H
+
+#include "Constants.h"
+#include "SaveIndex.h"
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QIcon>
+#include <QListWidget>
+#include <QPixmap>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+namespace SPR
+{
+
+	// Lists the saves of one directory from its SaveIndex, with thumbnails, and follows
+	// the index as it updates. "Other File..." falls back to a plain file dialog.
+	class SaveBrowser : public QDialog
+	{
+		Q_OBJECT
+
+	  public:
+		~SaveBrowser();
+		// Empty when cancelled
+		static QString getSaveFile(SaveIndex &index, QWidget *parent = nullptr);
+
+	  public slots:
+		void populate();
+
+	  private:
+		explicit SaveBrowser(SaveIndex &index, QWidget *parent = nullptr);
+
+		void browse();
+
+		SaveIndex &m_index;
+		QListWidget *m_list;
+		QDialogButtonBox *m_buttonBox;
+		QString m_selected;
+	};
+
+}	 // namespace SPR
+
+#endif	  // SAVEBROWSER_H
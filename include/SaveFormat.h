@@ -0,0 +1,152 @@
+#ifndef SAVEFORMAT_H
+#define SAVEFORMAT_H
+
+#include "Constants.h"
+#include "GameField.h"
+#include "MineSweeper.h"
+#include "Move.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFileDevice>
+#include <QIODevice>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <zlib.h>
+
+namespace SPR
+{
+
+	// Everything stored in front of the cell data
+	struct SaveHeader
+	{
+		quint16 version = 0;
+		qint32 width = 0;
+		qint32 height = 0;
+		qint32 mines = 0;
+		qint32 elapsed = 0;
+		bool timerRunning = false;
+		quint8 encoding = 0;
+		qint64 journalSequence = 0;	   // last journal entry the board already contains
+		quint8 state = 0;
+		quint32 seed = 0;
+		qint64 payloadSize = 0;
+		quint32 checksum = 0;		// crc32 of the payload
+	};
+
+	// Write-only pass-through that keeps a crc32 and a count of what went through it
+	class ChecksumDevice : public QIODevice
+	{
+	  public:
+		explicit ChecksumDevice(QIODevice *target);
+
+		bool isSequential() const override;
+		quint32 checksum() const;
+		qint64 written() const;
+
+	  protected:
+		qint64 readData(char *data, qint64 maxSize) override;
+		qint64 writeData(const char *data, qint64 size) override;
+
+	  private:
+		QIODevice *m_target;
+		uLong m_checksum;
+		qint64 m_written;
+	};
+
+	// Binary save file, written through QDataStream so the byte order does not depend on
+	// the machine. A fixed HEADER_SIZE header with its own crc holds the dimensions, the
+	// game state, the seed, the MoveJournal sequence the board includes and the size and
+	// crc of the payload, so saves can be listed and verified without building a board.
+	// The payload is one of three encodings:
+	//  - Planes: one packed plane per cell member (mine and discovered take one bit per
+	//    cell, disarmed two, neighbours four), each cut into SAVE_CHUNK_BYTES chunks that
+	//    are compressed independently, with a size table up front so both directions run
+	//    on the pool.
+	//  - Records: the GameField array as it sits in memory, copied from a mapped file in
+	//    one memcpy.
+	//  - Moves: the seed, the first click, flags placed before it and the move list, from
+	//    which a generated board is rebuilt on load.
+	// INI saves of the original format are read by LegacyIniReader.
+	class SaveFormat
+	{
+	  public:
+		static constexpr quint32 MAGIC = 0x44534D53;	// "DSMS"
+		static constexpr quint16 VERSION = 1;
+		static constexpr int HEADER_SIZE = 64;
+
+		enum Encoding : quint8
+		{
+			Planes,
+			Records,
+			Moves
+		};
+
+		enum State : quint8
+		{
+			NotStarted,
+			InProgress,
+			Won,
+			Lost
+		};
+
+		static bool isBinary(QIODevice *device);
+		// progress, when given, is called with the percentage written so far
+		static bool write(QIODevice *device,
+						  const MineSweeper &board,
+						  int elapsed,
+						  bool timerRunning,
+						  Encoding encoding = Planes,
+						  qint64 journalSequence = 0,
+						  const std::function< void(int) > &progress = nullptr);
+		static bool writeMoves(QIODevice *device,
+							   const MineSweeper &board,
+							   const MoveLog &log,
+							   int elapsed,
+							   bool timerRunning,
+							   qint64 journalSequence = 0);
+		// log, when given, receives the start board and moves of a Moves save
+		static bool read(QIODevice *device, MineSweeper &board, SaveHeader &header, MoveLog *log = nullptr);
+
+		// Reads only the header and leaves the device at the payload
+		static bool readHeader(QIODevice *device, SaveHeader &header);
+		// Checks the payload against the header's size and crc
+		static bool verify(QIODevice *device);
+		static State stateOf(const MineSweeper &board);
+
+		// True when replaying log gives exactly board, so writeMoves can stand in for it
+		static bool reproduces(const MoveLog &log, const MineSweeper &board);
+
+	  private:
+		struct Plane
+		{
+			qint8 GameField::*member;
+			int bits;
+		};
+
+		static const Plane PLANES[4];
+
+		static qint64 planeBytes(const MineSweeper &board, const Plane &plane);
+		static QByteArray pack(const MineSweeper &board, const Plane &plane);
+		static bool unpack(MineSweeper &board, const Plane &plane, const QByteArray &bytes);
+		static void writePlane(QDataStream &out, const QByteArray &plane);
+		// expectedSize is what the board's dimensions allow; a chunk table claiming
+		// anything else is rejected before the plane is allocated
+		static bool readPlane(QDataStream &in, qint64 expectedSize, QByteArray &plane);
+		static bool writeRecords(QIODevice *device, const MineSweeper &board, const std::function< void(int) > &progress);
+		static bool readRecords(QIODevice *device, MineSweeper &board);
+		static bool readMoves(QDataStream &in, MineSweeper &board, MoveLog *log);
+		static SaveHeader headerFor(const MineSweeper &board, int elapsed, bool timerRunning, Encoding encoding, qint64 journalSequence);
+		static bool writeFramed(QIODevice *device, SaveHeader header, const std::function< bool(QIODevice *) > &payload);
+		static QByteArray encodeHeader(const SaveHeader &header);
+	};
+
+}	 // namespace SPR
+
+#endif	  // SAVEFORMAT_H
@@ -0,0 +1,95 @@
+#ifndef SAVEINDEX_H
+#define SAVEINDEX_H
+
+#include "BoardRenderer.h"
+#include "CellAtlas.h"
+#include "Constants.h"
+#include "LegacyIniReader.h"
+#include "MineSweeper.h"
+#include "SaveFormat.h"
+
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+namespace FileFormat
+{
+	const QString INDEX_FILE = ".doomsweeper.index";
+}	 // namespace FileFormat
+
+namespace SPR
+{
+
+	// Header and thumbnail of every save in one directory, kept in a small index file next
+	// to the saves so a browser can list them without opening any. Scans run on a worker
+	// thread and only parse saves whose modification time or size differ from the index;
+	// the directory is watched, so saves written or removed elsewhere are picked up too.
+	class SaveIndex : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		static constexpr quint32 MAGIC = 0x44535349;	// "DSSI"
+		static constexpr quint16 VERSION = 2;	 // 2: streamed as Qt 5.15 like the saves; older indexes are rebuilt
+
+		struct Entry
+		{
+			QString fileName;
+			qint64 modified = 0;	// msecs since epoch
+			qint64 size = 0;
+			bool readable = false;	  // kept when parsing failed, so the file is not retried
+			SaveHeader header;
+			QImage thumbnail;
+		};
+
+		// Reads the existing index right away; call refresh() to bring it up to date
+		explicit SaveIndex(const QString &directory, QObject *parent = nullptr);
+		~SaveIndex();
+
+		QString directory() const;
+		QString indexPath() const;
+		// Sorted by file name, as of the last finished scan
+		QVector< Entry > entries() const;
+
+		// Queues a scan unless one is already waiting to start
+		void refresh();
+		void waitForRefresh();
+
+		// At most THUMBNAIL_SIZE pixels a side, one flat colour per sampled cell
+		static QImage thumbnail(const MineSweeper &board, bool gameOver);
+
+		static bool readIndex(const QString &filepath, QVector< Entry > &entries);
+		static bool writeIndex(const QString &filepath, const QVector< Entry > &entries);
+
+	  signals:
+		// Emitted from the worker thread after a scan changed the entries
+		void updated();
+
+	  private:
+		void scan();
+		static bool readEntry(const QFileInfo &info, Entry &entry);
+
+		QString m_directory;
+		mutable QMutex m_mutex;
+		QVector< Entry > m_entries;
+		QAtomicInt m_queued;
+		QFileSystemWatcher m_watcher;
+		QThreadPool m_worker;	 // last, so it is drained before the rest goes away
+	};
+
+}	 // namespace SPR
+
+#endif	  // SAVEINDEX_H
@@ -0,0 +1,107 @@
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include "Constants.h"
+#include "GameField.h"
+#include "MineSweeper.h"
+#include "SaveFormat.h"
+
+#include <QFile>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace SPR
+{
+
+	// The running game's board, kept in a memory-mapped file and updated in place: a fixed
+	// 64-byte header, then the GameField array as it sits in memory. Only the cells marked
+	// changed since the last sync are copied. A killed process loses nothing already
+	// synced; the mapped pages are pushed to disk on a worker thread SESSION_FLUSH_MS
+	// after a change, in whatever order the kernel picks, so after a system crash the
+	// cells can be newer than the journal sequence in the header; journal entries replay
+	// idempotently, which makes that harmless. Only flushDurably() reports when the disk
+	// has the pages, so the journal keeps the moves a system crash could cost until a
+	// checkpoint's flush has finished.
+	class SessionFile : public QObject
+	{
+		Q_OBJECT
+
+	  public:
+		static constexpr quint32 MAGIC = 0x44534C53;	// "DSLS"
+		static constexpr quint16 VERSION = 1;
+
+		struct Header
+		{
+			quint32_le magic;
+			quint16_le version;
+			quint16_le cellSize;	// sizeof(GameField) of the build that wrote the file
+			qint32_le width;
+			qint32_le height;
+			qint32_le mines;
+			quint32_le seed;
+			qint32_le elapsed;
+			quint8 timerRunning;
+			quint8 state;
+			quint8 reserved[2];
+			qint64_le journalSequence;
+			quint8 padding[24];
+		};
+
+		explicit SessionFile(const QString &filepath, QObject *parent = nullptr);
+		~SessionFile();
+
+		QString path() const;
+		bool isOpen() const;
+
+		// Cells (x, y) that differ from the file; the next sync() copies them
+		void markChanged(const QRect &cells);
+		void markAllChanged();
+
+		// Brings the file up to date with board. Maps it first, sized for the board, when
+		// it is not open or the board's size changed
+		bool sync(const MineSweeper &board, int elapsed, bool timerRunning, qint64 journalSequence);
+		// The clock only, between syncs
+		void syncTime(int elapsed, bool timerRunning);
+
+		void flush();
+		// Writes the whole mapping on the worker, after any flush already queued, and
+		// emits flushed() here once it is on disk; the signals come in call order
+		void flushDurably();
+		void close();
+		void discard();
+
+		static bool readHeader(const QString &filepath, SaveHeader &header);
+		static bool load(const QString &filepath, MineSweeper &board, SaveHeader &header);
+
+	  signals:
+		void flushed(bool ok);
+
+	  private:
+		bool open(const MineSweeper &board);
+		void scheduleFlush();
+		static bool flushRange(uchar *data, qint64 size);
+		static const Header *validHeader(const uchar *data, qint64 size);
+		static SaveHeader toSaveHeader(const Header &header);
+
+		QFile m_file;
+		uchar *m_data;
+		qint64 m_size;
+		QRect m_dirty;
+		bool m_allDirty;
+		QPoint m_syncedFirstClick;	  // of the board last synced; populate() places every mine at once
+		QTimer m_flushTimer;
+		QThreadPool m_flusher;	  // last, so a running flush ends before the mapping goes
+	};
+
+	static_assert(sizeof(SessionFile::Header) == 64);
+
+}	 // namespace SPR
+
+#endif	  // SESSIONFILE_H
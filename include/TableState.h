@@ -1,12 +1,18 @@
 #ifndef TABLESTATE_H
 #define TABLESTATE_H
 
+#include "Constants.h"
+#include "LatencyTracker.h"
 #include "MineSweeper.h"
 
 #include <QAbstractTableModel>
 #include <QBrush>
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <QSize>
+#include <QVector>
+
+#include <utility>
 
 namespace SPR
 {
@@ -19,13 +25,24 @@ namespace SPR
 		~TableState() = default;
 
 		QVariant data(const QModelIndex &index, int role) const override;
+		const GameField &cell(int row, int column) const;
 		int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 		int columnCount(const QModelIndex &parent = QModelIndex()) const override;
 		void resetModel(int width, int height, int mine);
+		// Picks up a board that was filled in directly, e.g. by a load
+		void resumeLoaded();
 
 		MineSweeper &getMineSweeper();
 		const MineSweeper &getMineSweeper() const;
 		void setDebugMode(bool debug);
+		bool isDebugMode() const;
+		void setLatencyTracker(LatencyTracker *latency);
+		// Reveal work per event-loop turn, FRAME_BUDGET_MS unless set
+		void setFrameBudget(int msec);
+
+		// Changes made between these calls reach the views as a single dataChanged
+		void beginBatch();
+		void endBatch();
 
 		bool isGameInProgress() const;
 		bool hasLost() const;
@@ -45,12 +62,23 @@ namespace SPR
 	  private:
 		void init(const QModelIndex &index);
 		void discover(const QModelIndex &index);
+		void processReveal();
+		void markLatency(LatencyTracker::Stage stage);
+		void notifyChanged(const QRect &changed);
+		void addBatchChange(const QRect &changed);
+		void clearHighlight();
 
 		MineSweeper _model;
 		int m_mineDisplay;
 		bool m_initialized;
+		bool m_revealScheduled = false;
+		int m_frameBudget = FRAME_BUDGET_MS;
+		int m_batchDepth = 0;
+		QVector< QRect > m_batchChanged;
 		bool _debugMode = false;
+		LatencyTracker *m_latency = nullptr;
 		QTimer *m_highlightClearTimer = nullptr;
+		QRect m_highlighted;	// cells, x is the row and y the column
 	};
 
 }	 // namespace SPR
@@ -1,21 +1,31 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "BoardIO.h"
+#include "BoardRenderer.h"
+#include "BoardView.h"
 #include "Constants.h"
+#include "FrameStats.h"
+#include "LatencyTracker.h"
+#include "MiniMap.h"
+#include "MoveJournal.h"
 #include "Preferences.h"
+#include "ReplayRecorder.h"
+#include "ReplayRenderer.h"
 #include "Save.h"
 #include "SettingsDialog.h"
 #include "TableState.h"
-#include "TableView.h"
 #include "TopWidget.h"
 
 #include <QAction>
 #include <QApplication>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
 #include <QMainWindow>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QQueue>
 #include <QSettings>
 #include <QStatusBar>
 #include <QTimer>
@@ -36,18 +46,25 @@ namespace SPR
 
 		void setDebugMode(bool enabled);
 		bool isDebugMode() const;
+		void waitForSaves();
 
 	  public slots:
 		void quickSaveGame();
 		void saveGameAs();
 		void quickLoadGame();
 		void loadFrom();
+		void importBoard();
+		void exportBoard();
+		void exportImage();
+		void exportReplay();
 		void newGame();
 		void onGameLost();
 		void onGameWon();
 		void showAboutBox();
 		void showPreferences();
 		void updateView();
+		void dumpFrameStats();
+		void setCompactSaves(bool enabled);
 
 	  private:
 		void initTable();
@@ -57,17 +74,37 @@ namespace SPR
 		void saveSettings();
 		void loadTranslation(const QString& language);
 		void changeLanguage(const QString& locale);
+		void resumeLoaded(const MoveLog& log = MoveLog());
+		bool checkpoint();
+		void onCheckpointFlushed(bool ok);
+		void syncSession();
+
+		// A checkpoint waiting for its session flush; they complete in the order begun
+		struct PendingCheckpoint
+		{
+			bool synced = false;
+			bool report = false;	// Quick Save shows the outcome
+		};
 
 		// visuals
 		TopWidget* _topWidget;
-		TableView* _view;
+		BoardView* _view;
+		MiniMap* _miniMap;
 
 		// logic
 		TableState _model;
 		QTimer _timer;
+		FrameStats _frameStats;
+		LatencyTracker _latency;
+		ReplayRecorder _recorder;
 		Preferences _prefs;
 		Save _saveSystem;
+		MoveJournal _journal;
 		bool _debugMode;
+		bool _debugForced;	  // -dbg: on for this run only, not written to the settings
+		bool _compactSaves;
+		bool _sessionSyncQueued;
+		QQueue< PendingCheckpoint > _pendingCheckpoints;
 	};
 
 }	 // namespace SPR
@@ -6,12 +6,20 @@ TEMPLATE = app
 CONFIG += c++20 strict_c++
 
 # Qt Modules (Common)
-QT += core gui widgets testlib
+QT += core gui widgets concurrent testlib
 QT += core testlib
 
 # Include Paths
 INCLUDEPATH += . include/
 
+# zlib (PNG export). On Windows point ZLIB_ROOT at a zlib install
+!isEmpty(ZLIB_ROOT) {
+    INCLUDEPATH += $$ZLIB_ROOT/include
+    LIBS += -L$$ZLIB_ROOT/lib
+}
+win32: LIBS += -lzlib
+else: LIBS += -lz
+
 #---------------------------------------------------------------------
 # Solution (GUI) Configuration
 # Активируется через CONFIG += solution
@@ -26,11 +34,27 @@ solution {
                src/mainwindow.cpp \
                src/MineSweeper.cpp \
                src/Save.cpp \
+               src/SaveIndex.cpp \
+               src/SaveBrowser.cpp \
+               src/SessionFile.cpp \
+               src/SaveFormat.cpp \
+               src/LegacyIniReader.cpp \
+               src/BoardIO.cpp \
+               src/BoardCorpus.cpp \
                src/TableState.cpp \
                src/ActiveDelegate.cpp \
                src/InactiveDelegate.cpp \
+               src/CellAtlas.cpp \
                src/SettingsDialog.cpp \
-               src/TableView.cpp \
+               src/BoardView.cpp \
+               src/MiniMap.cpp \
+               src/FrameStats.cpp \
+               src/LatencyTracker.cpp \
+               src/BoardRenderer.cpp \
+               src/PngWriter.cpp \
+               src/MoveJournal.cpp \
+               src/ReplayRecorder.cpp \
+               src/ReplayRenderer.cpp \
                src/TopWidget.cpp
 
     HEADERS += include/mainwindow.h \
@@ -39,11 +63,28 @@ solution {
                include/GameField.h \
                include/MineSweeper.h \
                include/Save.h \
+               include/SaveIndex.h \
+               include/SaveBrowser.h \
+               include/SessionFile.h \
+               include/SaveFormat.h \
+               include/LegacyIniReader.h \
+               include/BoardIO.h \
+               include/BoardCorpus.h \
                include/TableState.h \
                include/ActiveDelegate.h \
                include/InactiveDelegate.h \
+               include/CellAtlas.h \
                include/SettingsDialog.h \
-               include/TableView.h \
+               include/BoardView.h \
+               include/MiniMap.h \
+               include/FrameStats.h \
+               include/LatencyTracker.h \
+               include/BoardRenderer.h \
+               include/PngWriter.h \
+               include/Move.h \
+               include/MoveJournal.h \
+               include/ReplayRecorder.h \
+               include/ReplayRenderer.h \
                include/TopWidget.h
 
     # Resources
@@ -53,6 +94,29 @@ solution {
                     translations/en_US.ts
 }
 
+#---------------------------------------------------------------------
+# Save Converter (command line)
+# Активируется через CONFIG += converter
+#---------------------------------------------------------------------
+converter {
+    TARGET = minesweeper-convert
+    QT -= gui widgets testlib
+    CONFIG += console cmdline
+    CONFIG -= app_bundle
+
+    SOURCES += src/converter.cpp \
+               src/LegacyIniReader.cpp \
+               src/MineSweeper.cpp \
+               src/SaveFormat.cpp
+
+    HEADERS += include/Constants.h \
+               include/GameField.h \
+               include/LegacyIniReader.h \
+               include/MineSweeper.h \
+               include/Move.h \
+               include/SaveFormat.h
+}
+
 #---------------------------------------------------------------------
 # Tests Configuration
 # Активируется через CONFIG += tests
@@ -66,11 +130,27 @@ tests {
     SOURCES += test/tests.cpp \
                src/MineSweeper.cpp \
                src/Save.cpp \
+               src/SaveIndex.cpp \
+               src/SaveBrowser.cpp \
+               src/SessionFile.cpp \
+               src/SaveFormat.cpp \
+               src/LegacyIniReader.cpp \
+               src/BoardIO.cpp \
+               src/BoardCorpus.cpp \
                src/TableState.cpp \
                src/TopWidget.cpp \
                src/ActiveDelegate.cpp \
                src/InactiveDelegate.cpp \
-               src/TableView.cpp \
+               src/CellAtlas.cpp \
+               src/BoardView.cpp \
+               src/MiniMap.cpp \
+               src/FrameStats.cpp \
+               src/LatencyTracker.cpp \
+               src/BoardRenderer.cpp \
+               src/PngWriter.cpp \
+               src/MoveJournal.cpp \
+               src/ReplayRecorder.cpp \
+               src/ReplayRenderer.cpp \
                src/SettingsDialog.cpp \
                src/mainwindow.cpp
 
@@ -78,14 +158,31 @@ tests {
     HEADERS += include/MineSweeper.h \
                include/GameField.h \
                include/Save.h \
+               include/SaveIndex.h \
+               include/SaveBrowser.h \
+               include/SessionFile.h \
+               include/SaveFormat.h \
+               include/LegacyIniReader.h \
+               include/BoardIO.h \
+               include/BoardCorpus.h \
                include/TableState.h \
                include/Constants.h \
                include/Preferences.h \
                include/mainwindow.h \
                include/SettingsDialog.h \
-               include/TableView.h \
+               include/BoardView.h \
+               include/MiniMap.h \
+               include/FrameStats.h \
+               include/LatencyTracker.h \
+               include/BoardRenderer.h \
+               include/PngWriter.h \
+               include/Move.h \
+               include/MoveJournal.h \
+               include/ReplayRecorder.h \
+               include/ReplayRenderer.h \
                include/ActiveDelegate.h \
                include/InactiveDelegate.h \
+               include/CellAtlas.h \
                include/TopWidget.h
 
     # GoogleTest Integration
@@ -7,18 +7,19 @@ namespace SPR
 
 	void ActiveDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 	{
-		GameField field = index.model()->data(index, Qt::UserRole).value< GameField >();
-		QStyleOptionButton buttonStyle;
-		getGeneralsForField(field, option, buttonStyle);
-		getStyleForField(field, buttonStyle);
-
-		if (field.isHighlighted)
+		GameField field;
+		if (const TableState *state = qobject_cast< const TableState * >(index.model()))
+		{
+			field = state->cell(index.row(), index.column());
+			field.isDebug = state->isDebugMode();
+		}
+		else
 		{
-			QColor highlightColor = QColor(255, 255, 0, 100);	 // light yellow
-			painter->fillRect(option.rect, highlightColor);
+			field = index.data(Qt::UserRole).value< GameField >();
 		}
 
-		QApplication::style()->drawControl(QStyle::CE_PushButton, &buttonStyle, painter, qobject_cast< QWidget * >(this->parent()));
+		const CellAtlas &atlas = CellAtlas::shared(m_fieldSize, painter->device()->devicePixelRatioF());
+		atlas.draw(painter, option.rect, spriteForField(field));
 	}
 
 	QSize ActiveDelegate::sizeHint(const QStyleOptionViewItem & /* option */, const QModelIndex & /* index */) const
@@ -27,44 +28,28 @@ namespace SPR
 												   // signature
 	}
 
-	void ActiveDelegate::getStyleForField(const GameField &field, QStyleOptionButton &buttonStyle) const
+	CellSprite ActiveDelegate::spriteForField(const GameField &field) const
 	{
 		if (field.isDebug && field.mine)
 		{
-			buttonStyle.icon = QIcon(QPixmap(CACO_PATH));
+			return field.discovered ? CellSprite::ExplodedMine : CellSprite::Mine;
 		}
 
-		else if (field.discovered && field.neighbours != 0)
-		{
-			buttonStyle.text = QString::number(field.neighbours);
-		}
-		else
+		if (field.discovered)
 		{
-			if (field.disarmed == 1)
-			{
-				buttonStyle.icon = QIcon(QPixmap(DISARMED_PATH));
-			}
-			else if (field.disarmed == 2)
-			{
-				buttonStyle.icon = QIcon(QPixmap(QUESTION_PATH));
-			}
+			return field.neighbours != 0 ? numberSprite(field.neighbours) : CellSprite::Sunken;
 		}
-	}
-
-	void ActiveDelegate::getGeneralsForField(const GameField &field, const QStyleOptionViewItem &option, QStyleOptionButton &buttonStyle) const
-	{
-		buttonStyle.rect = option.rect;
-		buttonStyle.iconSize = QSize(ICON_SIZE, ICON_SIZE);
-		buttonStyle.state |= QStyle::State_Enabled | option.state;
 
-		if (field.discovered)
+		if (field.disarmed == 1)
 		{
-			buttonStyle.state |= QStyle::State_Sunken;
+			return CellSprite::Flag;
 		}
-		else
+		else if (field.disarmed == 2)
 		{
-			buttonStyle.state |= QStyle::State_Raised;
+			return CellSprite::Question;
 		}
+
+		return field.isHighlighted ? CellSprite::Highlight : CellSprite::Raised;
 	}
 
 }	 // namespace SPR
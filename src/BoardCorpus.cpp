@@ -0,0 +1,265 @@
+#include "include/BoardCorpus.h"
+
+namespace SPR
+{
+
+	BoardCorpus::BoardCorpus() : m_file(), m_data(nullptr), m_size(0), m_count(0), m_index(nullptr) {}
+
+	BoardCorpus::~BoardCorpus()
+	{
+		close();
+	}
+
+	bool BoardCorpus::open(const QString &filepath, QString *error)
+	{
+		close();
+		m_file.setFileName(filepath);
+		if (!m_file.open(QIODevice::ReadOnly))
+		{
+			return fail(error, m_file.errorString());
+		}
+
+		m_size = m_file.size();
+		m_data = m_size >= qint64(sizeof(FileHeader)) ? m_file.map(0, m_size) : nullptr;
+		if (!m_data)
+		{
+			close();
+			return fail(error, "not a board corpus");
+		}
+
+		const FileHeader *fileHeader = reinterpret_cast< const FileHeader * >(m_data);
+		const quint64 count = fileHeader->count;
+		const quint64 indexOffset = fileHeader->indexOffset;
+		if (fileHeader->magic != MAGIC || fileHeader->version > VERSION)
+		{
+			close();
+			return fail(error, "not a board corpus, or written by a newer version");
+		}
+		if (indexOffset % 8 != 0 || indexOffset > quint64(m_size) || count > (quint64(m_size) - indexOffset) / 8)
+		{
+			close();
+			return fail(error, "the board index lies outside the file");
+		}
+
+		m_count = qint64(count);
+		m_index = reinterpret_cast< const quint64_le * >(m_data + indexOffset);
+		return true;
+	}
+
+	void BoardCorpus::close()
+	{
+		if (m_data)
+		{
+			m_file.unmap(const_cast< uchar * >(m_data));
+		}
+		m_file.close();
+		m_data = nullptr;
+		m_size = 0;
+		m_count = 0;
+		m_index = nullptr;
+	}
+
+	bool BoardCorpus::isOpen() const
+	{
+		return m_data != nullptr;
+	}
+
+	qint64 BoardCorpus::count() const
+	{
+		return m_count;
+	}
+
+	const BoardCorpus::BoardHeader *BoardCorpus::header(qint64 index) const
+	{
+		if (index < 0 || index >= m_count)
+		{
+			return nullptr;
+		}
+
+		const quint64 offset = m_index[index];
+		if (offset % 8 != 0 || offset < sizeof(FileHeader) || offset > quint64(m_size) - sizeof(BoardHeader))
+		{
+			return nullptr;
+		}
+
+		const BoardHeader *boardHeader = reinterpret_cast< const BoardHeader * >(m_data + offset);
+		const qint64 width = boardHeader->width;
+		const qint64 height = boardHeader->height;
+		if (!MineSweeper::fitsBoard(width, height))
+		{
+			return nullptr;
+		}
+		if (bitmapBytes(width * height) > m_size - qint64(offset) - qint64(sizeof(BoardHeader)))
+		{
+			return nullptr;
+		}
+		return boardHeader;
+	}
+
+	// Decoding the bitmap is linear in the board, nothing else depends on the corpus size
+	bool BoardCorpus::load(qint64 index, MineSweeper &board) const
+	{
+		const BoardHeader *boardHeader = header(index);
+		if (!boardHeader)
+		{
+			return false;
+		}
+
+		const int width = boardHeader->width;
+		const int height = boardHeader->height;
+		const uchar *bitmap = reinterpret_cast< const uchar * >(boardHeader + 1);
+
+		// Decoded aside, so a bad entry leaves the caller's board as it was
+		MineSweeper loaded;
+		loaded.reset(width, height, 0);
+		loaded.setSeed(boardHeader->seed);
+		if (QRect(0, 0, width, height).contains(boardHeader->firstX, boardHeader->firstY))
+		{
+			loaded.setFirstClick(QPoint(boardHeader->firstX, boardHeader->firstY));	   // seed and click rebuild it
+		}
+		GameField *cells = loaded.cells();
+		for (long long i = 0; i < loaded.size(); ++i)
+		{
+			cells[i].mine = (bitmap[i >> 3] >> (i & 7)) & 1;
+		}
+		loaded.recountMines();
+		if (loaded.totalMineNr() != boardHeader->mines)
+		{
+			return false;
+		}
+
+		board = std::move(loaded);
+		return true;
+	}
+
+	BoardCorpus::Difficulty BoardCorpus::difficultyOf(int width, int height, int mines)
+	{
+		if (width == 9 && height == 9 && mines == 10)
+		{
+			return Beginner;
+		}
+		if (width == 16 && height == 16 && mines == 40)
+		{
+			return Intermediate;
+		}
+		if (width == 30 && height == 16 && mines == 99)
+		{
+			return Expert;
+		}
+		return Custom;
+	}
+
+	qint64 BoardCorpus::bitmapBytes(qint64 cells)
+	{
+		return (cells + 63) / 64 * 8;
+	}
+
+	bool BoardCorpus::fail(QString *error, const QString &message)
+	{
+		if (error)
+		{
+			*error = message;
+		}
+		return false;
+	}
+
+	BoardCorpusWriter::BoardCorpusWriter(const QString &filepath) : m_file(filepath), m_offsets(), m_record() {}
+
+	bool BoardCorpusWriter::open()
+	{
+		m_offsets.clear();
+		if (!m_file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
+
+		// Placeholder until commit() knows the count and where the index starts
+		const QByteArray placeholder(sizeof(BoardCorpus::FileHeader), '\0');
+		return m_file.write(placeholder) == placeholder.size();
+	}
+
+	bool BoardCorpusWriter::append(const MineSweeper &board)
+	{
+		if (!m_file.isOpen() || board.size() <= 0)
+		{
+			return false;
+		}
+
+		const qint64 bitmap = BoardCorpus::bitmapBytes(board.size());
+		m_record.fill('\0', qsizetype(sizeof(BoardCorpus::BoardHeader) + bitmap));
+
+		BoardCorpus::BoardHeader boardHeader;
+		std::memset(&boardHeader, 0, sizeof(boardHeader));
+		boardHeader.width = board.width();
+		boardHeader.height = board.height();
+		boardHeader.mines = board.totalMineNr();
+		boardHeader.seed = board.seed();
+		boardHeader.threeBV = board.threeBV();
+		boardHeader.firstX = board.firstClick().x();
+		boardHeader.firstY = board.firstClick().y();
+		boardHeader.difficulty = BoardCorpus::difficultyOf(board.width(), board.height(), board.totalMineNr());
+		std::memcpy(m_record.data(), &boardHeader, sizeof(boardHeader));
+
+		uchar *bits = reinterpret_cast< uchar * >(m_record.data() + sizeof(boardHeader));
+		const GameField *cells = board.cells();
+		for (long long i = 0; i < board.size(); ++i)
+		{
+			if (cells[i].mine)
+			{
+				bits[i >> 3] |= uchar(1 << (i & 7));
+			}
+		}
+
+		const qint64 offset = m_file.pos();
+		if (m_file.write(m_record) != m_record.size())
+		{
+			return false;
+		}
+		m_offsets.append(quint64(offset));
+		return true;
+	}
+
+	bool BoardCorpusWriter::commit()
+	{
+		if (!m_file.isOpen())
+		{
+			return false;
+		}
+
+		const qint64 indexOffset = m_file.pos();
+		QByteArray index(m_offsets.size() * qsizetype(sizeof(quint64)), '\0');
+		qToLittleEndian< quint64 >(m_offsets.constData(), m_offsets.size(), index.data());
+
+		BoardCorpus::FileHeader fileHeader;
+		std::memset(&fileHeader, 0, sizeof(fileHeader));
+		fileHeader.magic = BoardCorpus::MAGIC;
+		fileHeader.version = BoardCorpus::VERSION;
+		fileHeader.count = quint64(m_offsets.size());
+		fileHeader.indexOffset = quint64(indexOffset);
+
+		const bool ok = m_file.write(index) == index.size() && m_file.seek(0)
+						&& m_file.write(reinterpret_cast< const char * >(&fileHeader), sizeof(fileHeader)) == qint64(sizeof(fileHeader));
+		if (!ok)
+		{
+			m_file.cancelWriting();
+			m_file.commit();
+			return false;
+		}
+		return m_file.commit();
+	}
+
+	void BoardCorpusWriter::cancel()
+	{
+		if (m_file.isOpen())
+		{
+			m_file.cancelWriting();
+			m_file.commit();
+		}
+	}
+
+	qint64 BoardCorpusWriter::count() const
+	{
+		return m_offsets.size();
+	}
+
+}	 // namespace SPR
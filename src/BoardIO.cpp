@@ -0,0 +1,267 @@
+#include "include/BoardIO.h"
+
+namespace SPR
+{
+
+	BoardIO::Format BoardIO::formatFor(const QString &filepath)
+	{
+		return QFileInfo(filepath).suffix().compare("mbf", Qt::CaseInsensitive) == 0 ? Mbf : Text;
+	}
+
+	// The target board is only replaced once the whole file has been accepted
+	bool BoardIO::read(const QString &filepath, MineSweeper &board, QString *error)
+	{
+		QFile file(filepath);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return fail(error, file.errorString());
+		}
+
+		MineSweeper loaded;
+		bool ok = false;
+		if (formatFor(filepath) == Mbf)
+		{
+			ok = readMbf(&file, loaded, error);
+		}
+		else if (uchar *mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr)
+		{
+			ok = parseText(reinterpret_cast< const char * >(mapped), file.size(), loaded, error);
+			file.unmap(mapped);
+		}
+		else
+		{
+			const QByteArray data = file.readAll();
+			ok = parseText(data.constData(), data.size(), loaded, error);
+		}
+
+		if (ok)
+		{
+			board = std::move(loaded);
+		}
+		return ok;
+	}
+
+	bool BoardIO::write(const QString &filepath, const MineSweeper &board, QString *error)
+	{
+		QSaveFile file(filepath);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return fail(error, file.errorString());
+		}
+
+		QString reason;
+		const bool ok = formatFor(filepath) == Mbf ? writeMbf(&file, board, &reason) : writeText(&file, board);
+		if (!ok)
+		{
+			file.cancelWriting();
+			return fail(error, reason.isEmpty() ? file.errorString() : reason);
+		}
+		return file.commit() || fail(error, file.errorString());
+	}
+
+	// Every row has the first row's length and line ending, so row y starts at y * stride
+	// and bands of rows are parsed independently, straight into the cell array
+	bool BoardIO::parseText(const char *data, qint64 size, MineSweeper &board, QString *error)
+	{
+		const char *newline = static_cast< const char * >(memchr(data, '\n', size_t(size)));
+		qint64 width = newline ? newline - data : size;
+		int eol = newline ? 1 : 0;
+		if (newline && width > 0 && data[width - 1] == '\r')
+		{
+			--width;
+			eol = 2;
+		}
+		if (width <= 0)
+		{
+			return fail(error, "the first row is empty");
+		}
+
+		const qint64 stride = width + eol;
+		qint64 height = size / stride;
+		const qint64 rest = size % stride;
+		const bool lastTerminated = rest == 0;
+		if (!lastTerminated && rest == width)
+		{
+			++height;	 // no line break after the last row
+		}
+		else if (!lastTerminated)
+		{
+			return fail(error, "rows differ in length");
+		}
+		if (!MineSweeper::fitsBoard(width, height))	   // each side fitting an int is not enough
+		{
+			return fail(error, "board too large");
+		}
+
+		board.reset(int(width), int(height), 0);
+		GameField *cells = board.cells();
+
+		const int bandRows = int(qMax< qint64 >(1, BOARD_IO_BAND_CELLS / width));
+		QVector< int > bands;
+		for (qint64 row = 0; row < height; row += bandRows)
+		{
+			bands.append(int(row));
+		}
+
+		// Each band reports the first row it could not parse, or -1
+		const QVector< qint64 > badRows = QtConcurrent::blockingMapped< QVector< qint64 > >(
+			bands,
+			[=](int first) -> qint64
+			{
+				const qint64 last = qMin< qint64 >(first + bandRows, height);
+				for (qint64 row = first; row < last; ++row)
+				{
+					const char *line = data + row * stride;
+					if (row < height - 1 || lastTerminated)
+					{
+						const bool terminated = eol == 2 ? line[width] == '\r' && line[width + 1] == '\n' : line[width] == '\n';
+						if (!terminated)
+						{
+							return row;
+						}
+					}
+
+					GameField *out = cells + row * width;
+					for (qint64 x = 0; x < width; ++x)
+					{
+						const char c = line[x];
+						if (c == '*')
+						{
+							out[x].mine = 1;
+						}
+						else if (c >= '0' && c <= '8')
+						{
+							out[x].discovered = FIELD_VISITED;
+						}
+						else if (c != '.')
+						{
+							return row;
+						}
+					}
+				}
+				return -1;
+			});
+
+		for (qint64 row : badRows)
+		{
+			if (row >= 0)
+			{
+				return fail(error, QString("line %1: unexpected character or length").arg(row + 1));
+			}
+		}
+
+		board.recountMines();
+		return true;
+	}
+
+	bool BoardIO::writeText(QIODevice *device, const MineSweeper &board)
+	{
+		const int width = board.width();
+		const int bandRows = qMax(1, BOARD_IO_BAND_CELLS / qMax(1, width));
+		QByteArray band;
+
+		for (int first = 0; first < board.height(); first += bandRows)
+		{
+			const int last = qMin(first + bandRows, board.height());
+			band.resize(qsizetype(last - first) * (width + 1));
+			char *out = band.data();
+			for (int y = first; y < last; ++y)
+			{
+				const GameField *row = board.cells() + qint64(y) * width;
+				for (int x = 0; x < width; ++x)
+				{
+					*out++ = row[x].mine ? '*' : row[x].discovered ? char('0' + row[x].neighbours) : '.';
+				}
+				*out++ = '\n';
+			}
+
+			if (device->write(band) != band.size())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool BoardIO::readMbf(QIODevice *device, MineSweeper &board, QString *error)
+	{
+		const QByteArray header = device->read(4);
+		if (header.size() != 4)
+		{
+			return fail(error, "truncated MBF header");
+		}
+
+		const uchar *bytes = reinterpret_cast< const uchar * >(header.constData());
+		const int width = bytes[0];
+		const int height = bytes[1];
+		const int mines = qFromBigEndian< quint16 >(bytes + 2);
+		if (width == 0 || height == 0 || mines > width * height)
+		{
+			return fail(error, "invalid MBF dimensions");
+		}
+
+		const QByteArray positions = device->read(qint64(mines) * 2);
+		if (positions.size() != mines * 2)
+		{
+			return fail(error, "truncated MBF mine list");
+		}
+
+		board.reset(width, height, 0);
+		const uchar *position = reinterpret_cast< const uchar * >(positions.constData());
+		for (int i = 0; i < mines; ++i, position += 2)
+		{
+			if (position[0] >= width || position[1] >= height)
+			{
+				return fail(error, QString("mine %1 lies outside the board").arg(i));
+			}
+			board.field(position[0], position[1]).mine = 1;
+		}
+
+		board.recountMines();
+		if (board.totalMineNr() != mines)
+		{
+			return fail(error, "MBF lists a mine twice");
+		}
+		return true;
+	}
+
+	bool BoardIO::writeMbf(QIODevice *device, const MineSweeper &board, QString *error)
+	{
+		if (board.width() > 255 || board.height() > 255 || board.totalMineNr() > 0xffff)
+		{
+			return fail(error, "MBF holds at most 255 x 255 cells and 65535 mines");
+		}
+
+		QByteArray bytes(4, '\0');
+		bytes[0] = char(board.width());
+		bytes[1] = char(board.height());
+		qToBigEndian< quint16 >(quint16(board.totalMineNr()), bytes.data() + 2);
+		for (int y = 0; y < board.height(); ++y)
+		{
+			for (int x = 0; x < board.width(); ++x)
+			{
+				if (board.fieldConst(x, y).mine)
+				{
+					bytes.append(char(x));
+					bytes.append(char(y));
+				}
+			}
+		}
+
+		if (bytes.size() != 4 + board.totalMineNr() * 2)
+		{
+			return fail(error, "mine count does not match the board");
+		}
+		return device->write(bytes) == bytes.size();
+	}
+
+	bool BoardIO::fail(QString *error, const QString &message)
+	{
+		if (error)
+		{
+			*error = message;
+		}
+		return false;
+	}
+
+}	 // namespace SPR
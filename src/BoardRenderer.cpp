@@ -0,0 +1,174 @@
+#include "include/BoardRenderer.h"
+
+namespace SPR
+{
+
+	BoardRenderer::BoardRenderer(const MineSweeper &board, bool gameOver, bool debug, int cellSize) :
+		m_board(board), m_activeDelegate(), m_inactiveDelegate(), m_delegate(gameOver ? &m_inactiveDelegate : &m_activeDelegate),
+		m_atlas(cellSize >= LOD_CELL_SIZE ? &CellAtlas::shared(cellSize, 1.0) : nullptr), m_cellSize(cellSize), m_debug(debug)
+	{
+	}
+
+	int BoardRenderer::cellSize() const
+	{
+		return m_cellSize;
+	}
+
+	int BoardRenderer::rowCount() const
+	{
+		return m_board.width();
+	}
+
+	int BoardRenderer::columnCount() const
+	{
+		return m_board.height();
+	}
+
+	QSize BoardRenderer::imageSize() const
+	{
+		return QSize(columnCount(), rowCount()) * m_cellSize;
+	}
+
+	CellSprite BoardRenderer::spriteAt(int row, int column) const
+	{
+		GameField field = m_board.fieldConst(row, column);
+		field.isDebug = m_debug;
+		return m_delegate->spriteForField(field);
+	}
+
+	void BoardRenderer::renderCells(QImage &target, const QRect &cells, const QPoint &origin) const
+	{
+		if (!m_atlas)
+		{
+			for (int row = cells.top(); row <= cells.bottom(); ++row)
+			{
+				for (int column = cells.left(); column <= cells.right(); ++column)
+				{
+					fillCell(target, (QPoint(column, row) - origin) * m_cellSize, flatColor(spriteAt(row, column)));
+				}
+			}
+			return;
+		}
+
+		QPainter painter(&target);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		for (int row = cells.top(); row <= cells.bottom(); ++row)
+		{
+			for (int column = cells.left(); column <= cells.right(); ++column)
+			{
+				const QRect rect((column - origin.x()) * m_cellSize, (row - origin.y()) * m_cellSize, m_cellSize, m_cellSize);
+				painter.drawImage(rect, m_atlas->image(), m_atlas->sourceRect(spriteAt(row, column)));
+			}
+		}
+	}
+
+	void BoardRenderer::updateCells(const MineSweeper &board, const QRect &cells)
+	{
+		for (int row = cells.top(); row <= cells.bottom(); ++row)
+		{
+			for (int column = cells.left(); column <= cells.right(); ++column)
+			{
+				m_board.field(row, column) = board.fieldConst(row, column);
+			}
+		}
+	}
+
+	void BoardRenderer::setGameOver(bool gameOver)
+	{
+		m_delegate = gameOver ? &m_inactiveDelegate : &m_activeDelegate;
+	}
+
+	QImage BoardRenderer::render() const
+	{
+		return render(QRect(0, 0, columnCount(), rowCount()));
+	}
+
+	// Tiles are painted in parallel, each through its own QImage header over a disjoint
+	// part of the result, so no two painters ever share a paint device.
+	QImage BoardRenderer::render(const QRect &cells) const
+	{
+		QImage image(cells.size() * m_cellSize, QImage::Format_ARGB32_Premultiplied);
+		if (image.isNull())
+		{
+			return image;
+		}
+
+		QVector< QRect > tiles;
+		for (int row = cells.top(); row <= cells.bottom(); row += TILE_CELLS)
+		{
+			for (int column = cells.left(); column <= cells.right(); column += TILE_CELLS)
+			{
+				tiles.append(QRect(column, row, TILE_CELLS, TILE_CELLS) & cells);
+			}
+		}
+
+		uchar *bits = image.bits();
+		const qsizetype bytesPerLine = image.bytesPerLine();
+		const int bytesPerPixel = image.depth() / 8;
+
+		QtConcurrent::blockingMap(tiles,
+								  [&](const QRect &tile)
+								  {
+									  const QPoint pixel = (tile.topLeft() - cells.topLeft()) * m_cellSize;
+									  QImage view(bits + pixel.y() * bytesPerLine + pixel.x() * bytesPerPixel,
+												  tile.width() * m_cellSize,
+												  tile.height() * m_cellSize,
+												  bytesPerLine,
+												  image.format());
+									  renderCells(view, tile, tile.topLeft());
+								  });
+
+		return image;
+	}
+
+	bool BoardRenderer::exportPng(QIODevice *device, qint64 bandBytes) const
+	{
+		const QSize size = imageSize();
+		const qint64 cellRowBytes = qint64(size.width()) * m_cellSize * 4;
+		const int bandRows = int(qBound< qint64 >(1, bandBytes / qMax< qint64 >(1, cellRowBytes), rowCount()));
+
+		PngWriter writer(device);
+		writer.setBackground(qRgb(222, 222, 222));
+		if (!writer.begin(size.width(), size.height()))
+		{
+			return false;
+		}
+
+		for (int row = 0; row < rowCount(); row += bandRows)
+		{
+			const QImage band = render(QRect(0, row, columnCount(), qMin(bandRows, rowCount() - row)));
+			if (band.isNull() || !writer.writeRows(band))
+			{
+				return false;
+			}
+		}
+
+		return writer.finish();
+	}
+
+	bool BoardRenderer::exportPng(const QString &filepath, qint64 bandBytes) const
+	{
+		QSaveFile file(filepath);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
+
+		if (!exportPng(&file, bandBytes))
+		{
+			file.cancelWriting();
+			return false;
+		}
+		return file.commit();
+	}
+
+	void BoardRenderer::fillCell(QImage &target, const QPoint &topLeft, QRgb color) const
+	{
+		for (int y = 0; y < m_cellSize; ++y)
+		{
+			QRgb *line = reinterpret_cast< QRgb * >(target.scanLine(topLeft.y() + y)) + topLeft.x();
+			std::fill(line, line + m_cellSize, color);
+		}
+	}
+
+}	 // namespace SPR
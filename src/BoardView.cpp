@@ -0,0 +1,637 @@
+#include "include/BoardView.h"
+
+namespace SPR
+{
+
+	BoardView::BoardView(QWidget *parent) :
+		QAbstractScrollArea(parent), m_model(nullptr), m_activeDelegate(), m_inactiveDelegate(), m_delegate(&m_activeDelegate),
+		m_pressedIndex(), m_pendingInput(), m_inputScheduled(false), m_tiles(TILE_CACHE_KB), m_stats(nullptr), m_latency(nullptr), m_tileRatio(1.0), m_cellSize(FIELD_SIZE), m_active(true),
+		m_needsScrolling(false)
+	{
+		horizontalScrollBar()->setSingleStep(m_cellSize);
+		verticalScrollBar()->setSingleStep(m_cellSize);
+	}
+
+	void BoardView::setModel(TableState *model)
+	{
+		if (m_model == model)
+		{
+			return;
+		}
+
+		if (m_model)
+		{
+			disconnect(m_model, nullptr, this, nullptr);
+		}
+
+		m_model = model;
+
+		if (m_model)
+		{
+			connect(m_model, &TableState::dataChanged, this, &BoardView::onDataChanged);
+			connect(m_model, &TableState::layoutChanged, this, &BoardView::onLayoutChanged);
+			connect(m_model, &TableState::modelReset, this, &BoardView::onLayoutChanged);
+		}
+
+		onLayoutChanged();
+	}
+
+	TableState *BoardView::model() const
+	{
+		return m_model;
+	}
+
+	QModelIndex BoardView::indexAt(const QPoint &pos) const
+	{
+		if (!m_model)
+		{
+			return QModelIndex();
+		}
+
+		const int x = pos.x() + horizontalScrollBar()->value();
+		const int y = pos.y() + verticalScrollBar()->value();
+		if (x < 0 || y < 0)
+		{
+			return QModelIndex();
+		}
+
+		const int column = x / m_cellSize;
+		const int row = y / m_cellSize;
+		if (row >= m_model->rowCount() || column >= m_model->columnCount())
+		{
+			return QModelIndex();
+		}
+
+		return m_model->index(row, column);
+	}
+
+	QRect BoardView::visualRect(int row, int column) const
+	{
+		return QRect(column * m_cellSize - horizontalScrollBar()->value(),
+					 row * m_cellSize - verticalScrollBar()->value(),
+					 m_cellSize,
+					 m_cellSize);
+	}
+
+	QRect BoardView::visibleCells() const
+	{
+		if (!m_model)
+		{
+			return QRect();
+		}
+
+		const QRect pixels(QPoint(horizontalScrollBar()->value(), verticalScrollBar()->value()), viewport()->size());
+		const QRect cells(QPoint(pixels.left() / m_cellSize, pixels.top() / m_cellSize),
+						  QPoint(pixels.right() / m_cellSize, pixels.bottom() / m_cellSize));
+		return cells & QRect(0, 0, m_model->columnCount(), m_model->rowCount());
+	}
+
+	void BoardView::adjustSizeToContents()
+	{
+		const QSize content = contentSize();
+		const QSize available = screen()->availableGeometry().size() - QSize(SCREEN_MARGIN, SCREEN_MARGIN);
+		const QSize visible = content.boundedTo(available);
+
+		int width = visible.width() + 2 * frameWidth();
+		int height = visible.height() + 2 * frameWidth();
+		if (content.width() > visible.width())
+		{
+			height += horizontalScrollBar()->sizeHint().height();
+		}
+		if (content.height() > visible.height())
+		{
+			width += verticalScrollBar()->sizeHint().width();
+		}
+
+		m_needsScrolling = visible != content;
+		setFixedSize(width, height);
+		updateScrollBars();
+	}
+
+	bool BoardView::needsScrolling() const
+	{
+		return m_needsScrolling;
+	}
+
+	bool BoardView::isActive() const
+	{
+		return m_active;
+	}
+
+	int BoardView::cellSize() const
+	{
+		return m_cellSize;
+	}
+
+	CellSprite BoardView::spriteAt(int row, int column) const
+	{
+		GameField field = m_model->cell(row, column);
+		field.isDebug = m_model->isDebugMode();
+		return m_delegate->spriteForField(field);
+	}
+
+	QRgb BoardView::flatColorAt(int row, int column) const
+	{
+		return flatColor(spriteAt(row, column));
+	}
+
+	void BoardView::centerOn(int row, int column)
+	{
+		horizontalScrollBar()->setValue(column * m_cellSize + m_cellSize / 2 - viewport()->width() / 2);
+		verticalScrollBar()->setValue(row * m_cellSize + m_cellSize / 2 - viewport()->height() / 2);
+	}
+
+	void BoardView::activate()
+	{
+		m_active = true;
+		m_delegate = &m_activeDelegate;
+		m_pressedIndex = QModelIndex();
+		m_pendingInput.clear();	   // clicks aimed at the previous game
+		invalidateTiles();
+	}
+
+	void BoardView::deactivate()
+	{
+		m_active = false;
+		m_delegate = &m_inactiveDelegate;
+		invalidateTiles();
+	}
+
+	void BoardView::setFrameStats(FrameStats *stats)
+	{
+		if (m_stats)
+		{
+			disconnect(m_stats, nullptr, this, nullptr);
+		}
+
+		m_stats = stats;
+
+		if (m_stats)
+		{
+			connect(m_stats, &FrameStats::updated, this, [this]() { viewport()->update(statsOverlayRect()); });
+		}
+		viewport()->update();
+	}
+
+	void BoardView::setLatencyTracker(LatencyTracker *latency)
+	{
+		m_latency = latency;
+		viewport()->update();
+	}
+
+	void BoardView::setCellSize(int cellSize)
+	{
+		if (cellSize == m_cellSize || cellSize <= 0)
+		{
+			return;
+		}
+
+		const QPoint center = visibleCells().center();
+		m_cellSize = cellSize;
+		horizontalScrollBar()->setSingleStep(m_cellSize);
+		verticalScrollBar()->setSingleStep(m_cellSize);
+		updateScrollBars();
+		invalidateTiles();
+
+		emit zoomChanged(m_cellSize);
+		centerOn(center.y(), center.x());
+	}
+
+	void BoardView::zoomIn()
+	{
+		for (int level : ZOOM_LEVELS)
+		{
+			if (level > m_cellSize)
+			{
+				setCellSize(level);
+				return;
+			}
+		}
+	}
+
+	void BoardView::zoomOut()
+	{
+		for (int i = int(std::size(ZOOM_LEVELS)) - 1; i >= 0; --i)
+		{
+			if (ZOOM_LEVELS[i] < m_cellSize)
+			{
+				setCellSize(ZOOM_LEVELS[i]);
+				return;
+			}
+		}
+	}
+
+	void BoardView::resetZoom()
+	{
+		setCellSize(FIELD_SIZE);
+	}
+
+	void BoardView::paintEvent(QPaintEvent *event)
+	{
+		const int xOffset = horizontalScrollBar()->value();
+		const int yOffset = verticalScrollBar()->value();
+		const QRect exposed = event->rect().translated(xOffset, yOffset) & QRect(QPoint(0, 0), contentSize());
+		if (!m_model || exposed.isEmpty())
+		{
+			return;
+		}
+
+		if (viewport()->devicePixelRatioF() != m_tileRatio)
+		{
+			m_tiles.clear();
+			m_tileRatio = viewport()->devicePixelRatioF();
+		}
+
+		if (m_stats)
+		{
+			m_stats->beginFrame();
+		}
+
+		const int tileSize = cellsPerTile() * m_cellSize;
+		QPainter painter(viewport());
+		painter.translate(-xOffset, -yOffset);
+
+		int cellsPainted = 0;
+		for (int tileRow = exposed.top() / tileSize; tileRow <= exposed.bottom() / tileSize; ++tileRow)
+		{
+			for (int tileColumn = exposed.left() / tileSize; tileColumn <= exposed.right() / tileSize; ++tileColumn)
+			{
+				cellsPainted += paintTile(&painter, tileRow, tileColumn);
+			}
+		}
+
+		if (m_stats)
+		{
+			m_stats->endFrame(cellsPainted);
+			painter.resetTransform();
+			paintStatsOverlay(&painter);
+		}
+
+		if (m_latency)
+		{
+			m_latency->painted();
+		}
+	}
+
+	void BoardView::mousePressEvent(QMouseEvent *event)
+	{
+		if (!m_active)
+		{
+			return;
+		}
+
+		if (m_latency)
+		{
+			m_latency->begin();
+		}
+
+		switch (event->button())
+		{
+		case Qt::LeftButton:
+		{
+			m_pressedIndex = indexAt(event->pos());
+			if (m_pressedIndex.isValid())
+			{
+				emit pressed(m_pressedIndex);
+			}
+			break;
+		}
+
+		case Qt::MiddleButton:
+		{
+			QModelIndex index = indexAt(event->pos());
+
+			if (index.isValid())
+			{
+				queueInput(Move::Middle, index);
+			}
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+		}
+	}
+
+	void BoardView::mouseReleaseEvent(QMouseEvent *event)
+	{
+		if (!m_active)
+		{
+			return;
+		}
+
+		if (m_latency)
+		{
+			m_latency->begin();
+		}
+
+		QModelIndex index = indexAt(event->pos());
+		if (!index.isValid())
+		{
+			m_pressedIndex = QModelIndex();
+			return;
+		}
+
+		switch (event->button())
+		{
+		case Qt::RightButton:
+		{
+			queueInput(Move::Flag, index);
+			break;
+		}
+
+		case Qt::LeftButton:
+		{
+			if (event->buttons() & Qt::RightButton)
+			{
+				queueInput(Move::Chord, index);
+			}
+			else if (index == m_pressedIndex)
+			{
+				queueInput(Move::Reveal, index);
+			}
+			m_pressedIndex = QModelIndex();
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+		}
+	}
+
+	void BoardView::resizeEvent(QResizeEvent *event)
+	{
+		QAbstractScrollArea::resizeEvent(event);
+		updateScrollBars();
+	}
+
+	void BoardView::wheelEvent(QWheelEvent *event)
+	{
+		if (event->modifiers() & Qt::ControlModifier)
+		{
+			if (event->angleDelta().y() > 0)
+			{
+				zoomIn();
+			}
+			else if (event->angleDelta().y() < 0)
+			{
+				zoomOut();
+			}
+			event->accept();
+			return;
+		}
+
+		QAbstractScrollArea::wheelEvent(event);
+	}
+
+	void BoardView::scrollContentsBy(int dx, int dy)
+	{
+		QAbstractScrollArea::scrollContentsBy(dx, dy);
+		if (m_stats)
+		{
+			viewport()->update(statsOverlayRect());	   // keep the overlay pinned
+		}
+	}
+
+	void BoardView::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+	{
+		if (!topLeft.isValid() || !bottomRight.isValid())
+		{
+			viewport()->update();
+			return;
+		}
+
+		const QRect changed(QPoint(topLeft.column(), topLeft.row()), QPoint(bottomRight.column(), bottomRight.row()));
+		if (m_stats)
+		{
+			m_stats->addDataChanged(qint64(changed.width()) * changed.height());
+		}
+
+		const int perTile = cellsPerTile();
+		for (int tileRow = changed.top() / perTile; tileRow <= changed.bottom() / perTile; ++tileRow)
+		{
+			for (int tileColumn = changed.left() / perTile; tileColumn <= changed.right() / perTile; ++tileColumn)
+			{
+				if (BoardTile *tile = m_tiles.object(tileKey(tileRow, tileColumn)))
+				{
+					tile->dirty |= changed & tileCells(tileRow, tileColumn);
+				}
+			}
+		}
+
+		const QRect first = visualRect(topLeft.row(), topLeft.column());
+		const QRect last = visualRect(bottomRight.row(), bottomRight.column());
+		viewport()->update(first.united(last));
+	}
+
+	void BoardView::onLayoutChanged()
+	{
+		m_pressedIndex = QModelIndex();
+		updateScrollBars();
+		invalidateTiles();
+	}
+
+	QSize BoardView::contentSize() const
+	{
+		if (!m_model)
+		{
+			return QSize(0, 0);
+		}
+		return QSize(m_model->columnCount() * m_cellSize, m_model->rowCount() * m_cellSize);
+	}
+
+	void BoardView::updateScrollBars()
+	{
+		const QSize content = contentSize();
+		const QSize visible = viewport()->size();
+
+		horizontalScrollBar()->setPageStep(visible.width());
+		horizontalScrollBar()->setRange(0, qMax(0, content.width() - visible.width()));
+		verticalScrollBar()->setPageStep(visible.height());
+		verticalScrollBar()->setRange(0, qMax(0, content.height() - visible.height()));
+	}
+
+	// Follows the zoom and the pixel ratio; both clear the cache when they change
+	int BoardView::cellsPerTile() const
+	{
+		return qMax(1, qFloor(TILE_PIXELS / (m_cellSize * m_tileRatio)));
+	}
+
+	QRect BoardView::tileCells(int tileRow, int tileColumn) const
+	{
+		const int perTile = cellsPerTile();
+		const QRect board(0, 0, m_model->columnCount(), m_model->rowCount());
+		return QRect(tileColumn * perTile, tileRow * perTile, perTile, perTile) & board;
+	}
+
+	int BoardView::paintTile(QPainter *painter, int tileRow, int tileColumn)
+	{
+		const QRect cells = tileCells(tileRow, tileColumn);
+		const quint64 key = tileKey(tileRow, tileColumn);
+
+		BoardTile *tile = m_tiles.object(key);
+		if (tile)
+		{
+			int cellsPainted = 0;
+			if (!tile->dirty.isEmpty())
+			{
+				cellsPainted = renderCells(tile->pixmap, tile->dirty, cells.topLeft());
+				tile->dirty = QRect();
+			}
+			painter->drawPixmap(cells.left() * m_cellSize, cells.top() * m_cellSize, tile->pixmap);
+			return cellsPainted;
+		}
+
+		tile = new BoardTile;
+		tile->pixmap = QPixmap(cells.size() * m_cellSize * m_tileRatio);
+		tile->pixmap.setDevicePixelRatio(m_tileRatio);
+		const int cellsPainted = renderCells(tile->pixmap, cells, cells.topLeft());
+		painter->drawPixmap(cells.left() * m_cellSize, cells.top() * m_cellSize, tile->pixmap);
+
+		const qint64 bytes = qint64(tile->pixmap.width()) * tile->pixmap.height() * tile->pixmap.depth() / 8;
+		m_tiles.insert(key, tile, qMax< qint64 >(1, bytes / 1024));
+		return cellsPainted;
+	}
+
+	int BoardView::renderCells(QPixmap &pixmap, const QRect &cells, const QPoint &origin) const
+	{
+		QPainter painter(&pixmap);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+		if (m_cellSize < LOD_CELL_SIZE)
+		{
+			// one pixel per cell, stretched by the blit
+			QImage image(cells.size(), QImage::Format_RGB32);
+			for (int row = cells.top(); row <= cells.bottom(); ++row)
+			{
+				QRgb *line = reinterpret_cast< QRgb * >(image.scanLine(row - cells.top()));
+				for (int column = cells.left(); column <= cells.right(); ++column)
+				{
+					line[column - cells.left()] = flatColorAt(row, column);
+				}
+			}
+
+			const QPoint topLeft = (cells.topLeft() - origin) * m_cellSize;
+			painter.drawImage(QRect(topLeft, cells.size() * m_cellSize), image);
+			return cells.width() * cells.height();
+		}
+
+		const CellAtlas &atlas = CellAtlas::shared(m_cellSize, m_tileRatio);
+		for (int row = cells.top(); row <= cells.bottom(); ++row)
+		{
+			for (int column = cells.left(); column <= cells.right(); ++column)
+			{
+				const QRect target((column - origin.x()) * m_cellSize, (row - origin.y()) * m_cellSize, m_cellSize, m_cellSize);
+				atlas.draw(&painter, target, spriteAt(row, column));
+			}
+		}
+		return cells.width() * cells.height();
+	}
+
+	QStringList BoardView::statsOverlayLines() const
+	{
+		QStringList lines = m_stats->summary();
+		if (m_latency)
+		{
+			lines << m_latency->summary();
+		}
+		return lines;
+	}
+
+	QRect BoardView::statsOverlayRect() const
+	{
+		const int lineHeight = fontMetrics().height();
+		const int lines = 4 + (m_latency ? 2 : 0);
+		return QRect(DEFAULT_SPACE, DEFAULT_SPACE, viewport()->width() - 2 * DEFAULT_SPACE, lines * lineHeight + 2 * DEFAULT_SPACE);
+	}
+
+	void BoardView::paintStatsOverlay(QPainter *painter) const
+	{
+		const QRect rect = statsOverlayRect();
+		painter->fillRect(rect, QColor(0, 0, 0, 160));
+		painter->setPen(Qt::white);
+		painter->drawText(rect.adjusted(DEFAULT_SPACE, DEFAULT_SPACE, -DEFAULT_SPACE, -DEFAULT_SPACE),
+						  Qt::AlignLeft | Qt::AlignTop,
+						  statsOverlayLines().join('\n'));
+	}
+
+	void BoardView::queueInput(Move::Type type, const QModelIndex &index)
+	{
+		Move move;
+		move.type = type;
+		move.row = index.row();
+		move.column = index.column();
+		m_pendingInput.append(move);
+
+		if (!m_inputScheduled)
+		{
+			m_inputScheduled = true;
+			QTimer::singleShot(0, this, &BoardView::flushInput);
+		}
+	}
+
+	void BoardView::flushInput()
+	{
+		m_inputScheduled = false;
+		const QVector< Move > input = std::exchange(m_pendingInput, QVector< Move >());
+		if (!m_model || input.isEmpty())
+		{
+			return;
+		}
+
+		m_model->beginBatch();
+		for (const Move &move : input)
+		{
+			if (!m_active)
+			{
+				break;	  // the game ended earlier in this burst
+			}
+
+			const QModelIndex index = m_model->index(move.row, move.column);
+			if (!index.isValid())
+			{
+				continue;
+			}
+
+			switch (move.type)
+			{
+			case Move::Reveal:
+			{
+				emit clicked(index);
+				break;
+			}
+
+			case Move::Flag:
+			{
+				emit rightClicked(index);
+				break;
+			}
+
+			case Move::Chord:
+			{
+				emit bothClicked(index);
+				break;
+			}
+
+			case Move::Middle:
+			{
+				emit middleClicked(index);
+				break;
+			}
+			}
+		}
+		m_model->endBatch();
+	}
+
+	void BoardView::invalidateTiles()
+	{
+		m_tiles.clear();
+		viewport()->update();
+		emit boardInvalidated();
+	}
+
+}	 // namespace SPR
@@ -0,0 +1,151 @@
+#include "include/CellAtlas.h"
+
+namespace SPR
+{
+
+	CellAtlas::CellAtlas(int cellSize, qreal devicePixelRatio, QStyle *style) :
+		m_cellSize(cellSize), m_physicalSize(qCeil(cellSize * devicePixelRatio)), m_devicePixelRatio(devicePixelRatio)
+	{
+		const int spriteCount = static_cast< int >(CellSprite::Count);
+
+		m_image = QImage(m_physicalSize * spriteCount, m_physicalSize, QImage::Format_ARGB32_Premultiplied);
+		m_image.fill(Qt::transparent);
+
+		{
+			QPainter painter(&m_image);
+			painter.scale(qreal(m_physicalSize) / m_cellSize, qreal(m_physicalSize) / m_cellSize);
+			for (int i = 0; i < spriteCount; ++i)
+			{
+				renderSprite(&painter, QRect(i * m_cellSize, 0, m_cellSize, m_cellSize), static_cast< CellSprite >(i), style);
+			}
+		}
+
+		m_pixmap = QPixmap::fromImage(m_image);
+	}
+
+	int CellAtlas::cellSize() const
+	{
+		return m_cellSize;
+	}
+
+	qreal CellAtlas::devicePixelRatio() const
+	{
+		return m_devicePixelRatio;
+	}
+
+	const QImage &CellAtlas::image() const
+	{
+		return m_image;
+	}
+
+	const QPixmap &CellAtlas::pixmap() const
+	{
+		return m_pixmap;
+	}
+
+	QRect CellAtlas::sourceRect(CellSprite sprite) const
+	{
+		return QRect(static_cast< int >(sprite) * m_physicalSize, 0, m_physicalSize, m_physicalSize);
+	}
+
+	void CellAtlas::draw(QPainter *painter, const QRect &target, CellSprite sprite) const
+	{
+		painter->drawPixmap(target, m_pixmap, sourceRect(sprite));
+	}
+
+	const CellAtlas &CellAtlas::shared(int cellSize, qreal devicePixelRatio)
+	{
+		static std::map< std::tuple< const QStyle *, int, qreal >, std::unique_ptr< CellAtlas > > cache;
+
+		QStyle *style = QApplication::style();
+		std::unique_ptr< CellAtlas > &atlas = cache[std::make_tuple(style, cellSize, devicePixelRatio)];
+		if (!atlas)
+		{
+			atlas = std::make_unique< CellAtlas >(cellSize, devicePixelRatio, style);
+		}
+		return *atlas;
+	}
+
+	void CellAtlas::renderSprite(QPainter *painter, const QRect &rect, CellSprite sprite, QStyle *style) const
+	{
+		QStyleOptionButton buttonStyle;
+		buttonStyle.rect = rect;
+		buttonStyle.iconSize = QSize(ICON_SIZE, ICON_SIZE);
+		buttonStyle.state = QStyle::State_Enabled;
+
+		switch (sprite)
+		{
+		case CellSprite::Sunken:
+		case CellSprite::ExplodedMine:
+		{
+			buttonStyle.state |= QStyle::State_Sunken;
+			break;
+		}
+
+		default:
+		{
+			if (sprite >= CellSprite::Number1 && sprite <= CellSprite::Number8)
+			{
+				buttonStyle.state |= QStyle::State_Sunken;
+			}
+			else
+			{
+				buttonStyle.state |= QStyle::State_Raised;
+			}
+			break;
+		}
+		}
+
+		switch (sprite)
+		{
+		case CellSprite::Flag:
+		{
+			buttonStyle.icon = QIcon(QPixmap(DISARMED_PATH));
+			break;
+		}
+
+		case CellSprite::Question:
+		{
+			buttonStyle.icon = QIcon(QPixmap(QUESTION_PATH));
+			break;
+		}
+
+		case CellSprite::Mine:
+		{
+			buttonStyle.icon = QIcon(QPixmap(CACO_PATH));
+			break;
+		}
+
+		case CellSprite::ExplodedMine:
+		{
+			buttonStyle.icon = QIcon(QPixmap(BLUE_CACO_PATH));
+			break;
+		}
+
+		case CellSprite::WrongFlag:
+		{
+			buttonStyle.icon = QIcon(QPixmap(DISARMED_RED_PATH));
+			break;
+		}
+
+		case CellSprite::Highlight:
+		{
+			QColor highlightColor = QColor(255, 255, 0, 100);	 // light yellow
+			painter->fillRect(rect, highlightColor);
+			break;
+		}
+
+		default:
+		{
+			if (sprite >= CellSprite::Number1 && sprite <= CellSprite::Number8)
+			{
+				buttonStyle.text = QString::number(static_cast< int >(sprite) - static_cast< int >(CellSprite::Number1) + 1);
+			}
+			break;
+		}
+		}
+
+		style->drawControl(QStyle::CE_PushButton, &buttonStyle, painter, nullptr);
+	}
+
+}	 // namespace SPR
@@ -0,0 +1,154 @@
+#include "include/FrameStats.h"
+
+namespace SPR
+{
+
+	FrameStats::FrameStats(QObject *parent) :
+		QObject(parent), m_frames(STATS_HISTORY), m_paintNs(STATS_HISTORY), m_latencyNs(STATS_HISTORY), m_frameCount(0),
+		m_latencyCount(0), m_pendingChanges(0), m_pendingChangedCells(0)
+	{
+		m_ticker.setInterval(STATS_TICK);
+		connect(&m_ticker, &QTimer::timeout, this, &FrameStats::onTick);
+	}
+
+	void FrameStats::setEnabled(bool enabled)
+	{
+		if (enabled == m_ticker.isActive())
+		{
+			return;
+		}
+
+		if (enabled)
+		{
+			m_tickTimer.start();
+			m_refreshTimer.start();
+			m_ticker.start();
+		}
+		else
+		{
+			m_ticker.stop();
+		}
+	}
+
+	bool FrameStats::isEnabled() const
+	{
+		return m_ticker.isActive();
+	}
+
+	void FrameStats::beginFrame()
+	{
+		m_paintTimer.start();
+	}
+
+	void FrameStats::endFrame(int cellsPainted)
+	{
+		Frame &frame = m_frames[m_frameCount % STATS_HISTORY];
+		frame.cells = cellsPainted;
+		frame.changes = m_pendingChanges;
+		frame.changedCells = m_pendingChangedCells;
+		m_paintNs[m_frameCount % STATS_HISTORY] = m_paintTimer.nsecsElapsed();
+		++m_frameCount;
+
+		m_pendingChanges = 0;
+		m_pendingChangedCells = 0;
+	}
+
+	void FrameStats::addDataChanged(qint64 cells)
+	{
+		++m_pendingChanges;
+		m_pendingChangedCells += cells;
+	}
+
+	QStringList FrameStats::summary() const
+	{
+		QStringList lines;
+		if (m_frameCount == 0)
+		{
+			lines << tr("no frames yet");
+			return lines;
+		}
+
+		const int frames = qMin(m_frameCount, STATS_HISTORY);
+		qint64 total = 0;
+		qint64 worst = 0;
+		for (int i = 0; i < frames; ++i)
+		{
+			total += m_paintNs[i];
+			worst = qMax(worst, m_paintNs[i]);
+		}
+
+		const int lastIndex = (m_frameCount - 1) % STATS_HISTORY;
+		const Frame &last = m_frames[lastIndex];
+		const qint64 latency = m_latencyCount ? m_latencyNs[(m_latencyCount - 1) % STATS_HISTORY] : 0;
+
+		lines << tr("paint %1 ms (avg %2, max %3)")
+					 .arg(m_paintNs[lastIndex] / 1e6, 0, 'f', 2)
+					 .arg(total / frames / 1e6, 0, 'f', 2)
+					 .arg(worst / 1e6, 0, 'f', 2);
+		lines << tr("cells painted %1").arg(last.cells);
+		lines << tr("dataChanged %1 (%2 cells)").arg(last.changes).arg(last.changedCells);
+		lines << tr("event loop latency %1 ms").arg(latency / 1e6, 0, 'f', 2);
+		return lines;
+	}
+
+	QVector< int > FrameStats::paintHistogram() const
+	{
+		return histogram(m_paintNs, qMin(m_frameCount, STATS_HISTORY));
+	}
+
+	QVector< int > FrameStats::latencyHistogram() const
+	{
+		return histogram(m_latencyNs, qMin(m_latencyCount, STATS_HISTORY));
+	}
+
+	bool FrameStats::dump(const QString &filepath) const
+	{
+		QFile file(filepath);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			return false;
+		}
+
+		QTextStream out(&file);
+		for (const QString &line : summary())
+		{
+			out << "# " << line << "\n";
+		}
+
+		const QVector< int > paint = paintHistogram();
+		const QVector< int > latency = latencyHistogram();
+		out << "bucket_ms,paint_frames,loop_ticks\n";
+		for (int bucket = 0; bucket < STATS_BUCKETS; ++bucket)
+		{
+			const QString label = bucket == STATS_BUCKETS - 1 ? QString(">=%1").arg(bucket) : QString::number(bucket);
+			out << label << "," << paint[bucket] << "," << latency[bucket] << "\n";
+		}
+
+		return out.status() == QTextStream::Ok;
+	}
+
+	void FrameStats::onTick()
+	{
+		const qint64 elapsed = m_tickTimer.nsecsElapsed();
+		m_tickTimer.restart();
+		m_latencyNs[m_latencyCount % STATS_HISTORY] = qMax< qint64 >(0, elapsed - qint64(STATS_TICK) * 1000000);
+		++m_latencyCount;
+
+		if (m_refreshTimer.elapsed() >= STATS_REFRESH)
+		{
+			m_refreshTimer.restart();
+			emit updated();
+		}
+	}
+
+	QVector< int > FrameStats::histogram(const QVector< qint64 > &samplesNs, int count)
+	{
+		QVector< int > buckets(STATS_BUCKETS, 0);
+		for (int i = 0; i < count; ++i)
+		{
+			buckets[qMin< qint64 >(samplesNs[i] / 1000000, STATS_BUCKETS - 1)]++;
+		}
+		return buckets;
+	}
+
+}	 // namespace SPR
@@ -5,27 +5,29 @@ namespace SPR
 
 	InactiveDelegate::InactiveDelegate(QObject *parent) : ActiveDelegate(parent) {}
 
-	void InactiveDelegate::getStyleForField(const GameField &field, QStyleOptionButton &buttonStyle) const
+	CellSprite InactiveDelegate::spriteForField(const GameField &field) const
 	{
 		if (field.disarmed > 0 && field.mine == 1)
 		{
-			buttonStyle.icon = QIcon(QPixmap(DISARMED_PATH));
+			return CellSprite::Flag;
 		}
 		else if (field.disarmed > 0 && field.mine == 0)
 		{
-			buttonStyle.icon = QIcon(QPixmap(DISARMED_RED_PATH));
+			return CellSprite::WrongFlag;
 		}
 		else if (field.discovered == 0 && field.mine == 1)
 		{
-			buttonStyle.icon = QIcon(QPixmap(CACO_PATH));
+			return CellSprite::Mine;
 		}
 		else if (field.discovered == 1 && field.mine == 1)
 		{
-			buttonStyle.icon = QIcon(QPixmap(BLUE_CACO_PATH));
+			return CellSprite::ExplodedMine;
 		}
-		else if (field.discovered == 1 && field.mine == 0 && field.neighbours != 0)
+		else if (field.discovered == 1 && field.neighbours != 0)
 		{
-			buttonStyle.text = QString::number(field.neighbours);
+			return numberSprite(field.neighbours);
 		}
+
+		return field.discovered ? CellSprite::Sunken : CellSprite::Raised;
 	}
 }	 // namespace SPR
@@ -0,0 +1,138 @@
+#include "include/LatencyTracker.h"
+
+namespace SPR
+{
+
+	LatencyTracker::LatencyTracker(QObject *parent) :
+		QObject(parent), m_samples(STATS_HISTORY), m_current(), m_sampleCount(0), m_active(false)
+	{
+		m_clock.start();
+	}
+
+	// A new input replaces an interaction that never reached dataChanged
+	void LatencyTracker::begin()
+	{
+		m_current = Sample();
+		m_current.at[Event] = m_clock.nsecsElapsed();
+		m_active = true;
+	}
+
+	void LatencyTracker::mark(Stage stage)
+	{
+		if (m_active && m_current.at[stage] == 0)
+		{
+			m_current.at[stage] = m_clock.nsecsElapsed();
+		}
+	}
+
+	void LatencyTracker::painted()
+	{
+		if (!m_active || m_current.at[DataChanged] == 0)
+		{
+			return;	   // this paint does not show the result of an input yet
+		}
+
+		m_current.at[Painted] = m_clock.nsecsElapsed();
+		m_active = false;
+
+		// Stages an input skipped inherit the time of the one before
+		for (int stage = Slot; stage < StageCount; ++stage)
+		{
+			if (m_current.at[stage] == 0)
+			{
+				m_current.at[stage] = m_current.at[stage - 1];
+			}
+		}
+
+		m_samples[m_sampleCount % STATS_HISTORY] = m_current;
+		++m_sampleCount;
+		writeSample(m_current);
+	}
+
+	int LatencyTracker::sampleCount() const
+	{
+		return m_sampleCount;
+	}
+
+	qint64 LatencyTracker::percentile(Stage stage, double fraction) const
+	{
+		const int count = qMin(m_sampleCount, STATS_HISTORY);
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		QVector< qint64 > values(count);
+		for (int i = 0; i < count; ++i)
+		{
+			values[i] = m_samples[i].at[stage] - m_samples[i].at[Event];
+		}
+
+		const int rank = qBound(0, int(fraction * count), count - 1);
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+		return values[rank];
+	}
+
+	QStringList LatencyTracker::summary() const
+	{
+		QStringList lines;
+		if (m_sampleCount == 0)
+		{
+			lines << tr("click to paint: no samples yet");
+			return lines;
+		}
+
+		lines << tr("click to paint p50 %1 ms, p90 %2, p99 %3, max %4")
+					 .arg(percentile(Painted, 0.5) / 1e6, 0, 'f', 2)
+					 .arg(percentile(Painted, 0.9) / 1e6, 0, 'f', 2)
+					 .arg(percentile(Painted, 0.99) / 1e6, 0, 'f', 2)
+					 .arg(percentile(Painted, 1.0) / 1e6, 0, 'f', 2);
+		lines << tr("p90 slot %1, engine %2, dataChanged %3 ms")
+					 .arg(percentile(Slot, 0.9) / 1e6, 0, 'f', 2)
+					 .arg(percentile(Engine, 0.9) / 1e6, 0, 'f', 2)
+					 .arg(percentile(DataChanged, 0.9) / 1e6, 0, 'f', 2);
+		return lines;
+	}
+
+	bool LatencyTracker::setLogFile(const QString &filepath)
+	{
+		m_log.close();
+		if (filepath.isEmpty())
+		{
+			return true;
+		}
+
+		QDir().mkpath(QFileInfo(filepath).absolutePath());
+		m_log.setFileName(filepath);
+		if (!m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+		{
+			return false;
+		}
+
+		if (m_log.size() == 0)
+		{
+			m_log.write("slot_us,engine_us,datachanged_us,paint_us\n");
+		}
+		return true;
+	}
+
+	void LatencyTracker::writeSample(const Sample &sample)
+	{
+		if (!m_log.isOpen())
+		{
+			return;
+		}
+
+		QTextStream out(&m_log);
+		out << (sample.at[Slot] - sample.at[Event]) / 1000 << "," << (sample.at[Engine] - sample.at[Event]) / 1000 << ","
+			<< (sample.at[DataChanged] - sample.at[Event]) / 1000 << "," << (sample.at[Painted] - sample.at[Event]) / 1000 << "\n";
+
+		if (m_sampleCount % LATENCY_LOG_EVERY == 0)
+		{
+			out << "# " << summary().join("; ") << "\n";
+		}
+		out.flush();
+		m_log.flush();
+	}
+
+}	 // namespace SPR
@@ -0,0 +1,260 @@
+#include "include/LegacyIniReader.h"
+
+namespace SPR
+{
+
+	bool LegacyIniReader::read(QIODevice *device, MineSweeper &board, SaveHeader &header, bool validate, QString *error)
+	{
+		enum Section
+		{
+			Other,
+			Board,
+			Game,
+			Timer
+		};
+
+		header = SaveHeader();
+		header.width = -1;
+		header.height = -1;
+
+		QVector< CellRecord > cells;
+		CellRecord current;
+		Section section = Other;
+		char line[1024];
+		qint64 lineNumber = 0;
+
+		while (true)
+		{
+			const qint64 read = device->readLine(line, sizeof(line));
+			if (read < 0)
+			{
+				break;
+			}
+			++lineNumber;
+
+			int begin = 0;
+			int end = int(read);
+			while (end > begin && (line[end - 1] == '\n' || line[end - 1] == '\r' || line[end - 1] == ' '))
+			{
+				--end;
+			}
+			while (begin < end && line[begin] == ' ')
+			{
+				++begin;
+			}
+			if (begin == end || line[begin] == ';' || line[begin] == '#')
+			{
+				continue;
+			}
+
+			if (line[begin] == '[')
+			{
+				const QByteArray name(line + begin + 1, qMax(0, end - begin - 2));
+				section = name == "Board" ? Board : name == "Game" ? Game : name == "Timer" ? Timer : Other;
+				continue;
+			}
+
+			const char *equals = static_cast< const char * >(memchr(line + begin, '=', end - begin));
+			if (!equals)
+			{
+				return fail(error, QString("line %1: expected key=value").arg(lineNumber));
+			}
+			const char *key = line + begin;
+			const int keyLength = int(equals - key);
+			const char *value = equals + 1;
+			const int valueLength = int(line + end - value);
+
+			switch (section)
+			{
+			case Board:
+			{
+				qint32 x = 0;
+				qint32 y = 0;
+				const char *member = nullptr;
+				qint32 number = 0;
+				if (!parseCellKey(key, keyLength, x, y, member) || !parseInt(value, valueLength, number))
+				{
+					return fail(error, QString("line %1: bad cell entry").arg(lineNumber));
+				}
+
+				// A cell's keys are adjacent, so only the cell being read is kept open
+				if (x != current.x || y != current.y)
+				{
+					if (current.x >= 0)
+					{
+						cells.append(current);
+					}
+					current = CellRecord();
+					current.x = x;
+					current.y = y;
+				}
+
+				const int memberLength = int(key + keyLength - member);
+				auto is = [member, memberLength](const char *name) { return int(strlen(name)) == memberLength && !memcmp(member, name, memberLength); };
+				if (is("mine"))
+				{
+					current.field.mine = qint8(number);
+				}
+				else if (is("discovered"))
+				{
+					current.field.discovered = qint8(number);
+				}
+				else if (is("disarmed"))
+				{
+					current.field.disarmed = qint8(number);
+				}
+				else if (is("neighbours"))
+				{
+					current.field.neighbours = qint8(number);
+				}
+				break;
+			}
+
+			case Game:
+			{
+				const QByteArray name(key, keyLength);
+				qint32 number = 0;
+				if (!parseInt(value, valueLength, number))
+				{
+					return fail(error, QString("line %1: bad number").arg(lineNumber));
+				}
+				if (name == "width")
+				{
+					header.width = number;
+				}
+				else if (name == "height")
+				{
+					header.height = number;
+				}
+				else if (name == "mine")
+				{
+					header.mines = number;
+				}
+				break;
+			}
+
+			case Timer:
+			{
+				const QByteArray name(key, keyLength);
+				if (name == "elapsed")
+				{
+					parseInt(value, valueLength, header.elapsed);
+				}
+				else if (name == "running")
+				{
+					header.timerRunning = QByteArray(value, valueLength) == "true";
+				}
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+			}
+		}
+		if (current.x >= 0)
+		{
+			cells.append(current);
+		}
+
+		if (!MineSweeper::fitsBoard(header.width, header.height) || header.mines < 0)
+		{
+			return fail(error, "missing or invalid [Game] size");
+		}
+
+		MineSweeper loaded;
+		loaded.reset(header.width, header.height, header.mines);
+		for (const CellRecord &cell : std::as_const(cells))
+		{
+			if (cell.x >= header.width || cell.y >= header.height)
+			{
+				return fail(error, QString("cell %1,%2 lies outside the board").arg(cell.x).arg(cell.y));
+			}
+			loaded.field(cell.x, cell.y) = cell.field;
+		}
+
+		if (validate)
+		{
+			const QPoint bad = loaded.firstNeighbourMismatch();
+			if (bad.x() >= 0)
+			{
+				return fail(error, QString("cell %1,%2 has a wrong neighbour count").arg(bad.x()).arg(bad.y()));
+			}
+		}
+
+		loaded.restoreCounters();
+		board = std::move(loaded);
+		header.version = 0;	   // not a binary save
+		header.state = SaveFormat::stateOf(board);
+		return true;
+	}
+
+	// Cell_<x>_<y>\<member>; QSettings writes the group separator as a backslash
+	bool LegacyIniReader::parseCellKey(const char *key, int length, qint32 &x, qint32 &y, const char *&member)
+	{
+		static const char prefix[] = "Cell_";
+		const int prefixLength = int(sizeof(prefix)) - 1;
+		if (length <= prefixLength || memcmp(key, prefix, prefixLength) != 0)
+		{
+			return false;
+		}
+
+		const char *end = key + length;
+		const char *underscore = static_cast< const char * >(memchr(key + prefixLength, '_', end - key - prefixLength));
+		if (!underscore)
+		{
+			return false;
+		}
+		const char *separator = underscore + 1;
+		while (separator < end && *separator != '\\' && *separator != '/')
+		{
+			++separator;
+		}
+		if (separator == end)
+		{
+			return false;
+		}
+
+		member = separator + 1;
+		return parseInt(key + prefixLength, int(underscore - key - prefixLength), x) &&
+			   parseInt(underscore + 1, int(separator - underscore - 1), y) && x >= 0 && y >= 0;
+	}
+
+	bool LegacyIniReader::parseInt(const char *text, int length, qint32 &value)
+	{
+		bool negative = false;
+		int i = 0;
+		if (i < length && text[i] == '-')
+		{
+			negative = true;
+			++i;
+		}
+		if (i == length)
+		{
+			return false;
+		}
+
+		qint64 result = 0;
+		for (; i < length; ++i)
+		{
+			if (text[i] < '0' || text[i] > '9' || result > std::numeric_limits< qint32 >::max())
+			{
+				return false;
+			}
+			result = result * 10 + (text[i] - '0');
+		}
+		value = qint32(negative ? -result : result);
+		return true;
+	}
+
+	bool LegacyIniReader::fail(QString *error, const QString &message)
+	{
+		if (error)
+		{
+			*error = message;
+		}
+		return false;
+	}
+
+}	 // namespace SPR
@@ -3,7 +3,11 @@
 namespace SPR
 {
 
-	MineSweeper::MineSweeper() : m_width(0), m_height(0), m_totalMineNr(0), m_discoveredFieldsNr(0), m_data() {}
+	MineSweeper::MineSweeper() :
+		m_width(0), m_height(0), m_totalMineNr(0), m_discoveredFieldsNr(0), m_mineRevealed(false), m_seed(0), m_firstClick(-1, -1), m_data(),
+		m_revealQueue()
+	{
+	}
 
 	void MineSweeper::reset(int width, int height, int mineNumber)
 	{
@@ -11,21 +15,46 @@ namespace SPR
 		m_height = height;
 		m_totalMineNr = mineNumber;
 		m_discoveredFieldsNr = 0;	 // no fields open so zero obviously
-		m_data.clear();
-
-		const int fieldsNr = size();
-		m_data.reserve(fieldsNr);
-		m_data.insert(m_data.begin(), fieldsNr, GameField());
-
-		srand(std::time(0));
+		m_mineRevealed = false;
+		m_revealQueue.clear();
+		m_data.fill(GameField(), size());	 // reuses the buffer when the size is unchanged
+		m_seed = QRandomGenerator::global()->generate();
+		m_firstClick = QPoint(-1, -1);
 	}
 
 	void MineSweeper::populate(int xToSkip, int yToSkip)
 	{
+		m_firstClick = QPoint(xToSkip, yToSkip);
 		populateMineCrew(xToSkip, yToSkip);
 		populateNeighbourhood();
 	}
 
+	void MineSweeper::setSeed(quint32 seed)
+	{
+		m_seed = seed;
+	}
+
+	quint32 MineSweeper::seed() const
+	{
+		return m_seed;
+	}
+
+	// False for boards filled in from outside, e.g. by a loader
+	bool MineSweeper::isGenerated() const
+	{
+		return m_firstClick.x() >= 0;
+	}
+
+	QPoint MineSweeper::firstClick() const
+	{
+		return m_firstClick;
+	}
+
+	void MineSweeper::setFirstClick(const QPoint &click)
+	{
+		m_firstClick = click;
+	}
+
 	void MineSweeper::populateMineCrew(int xToSkip, int yToSkip)
 	{
 		if (m_totalMineNr >= size())
@@ -36,10 +65,11 @@ namespace SPR
 
 		const uint64_t nomineFieldId = yToSkip * m_width + xToSkip;
 		int64_t mineMade = 0;	 // just counter, starts at zero
+		QRandomGenerator random(m_seed);
 
 		while (mineMade < m_totalMineNr)
 		{
-			const uint64_t fieldId = std::rand() % size();
+			const uint64_t fieldId = random.bounded(qint64(size()));
 
 			if (fieldId >= static_cast< size_t >(m_data.size()))	// Приведено к size_t
 			{
@@ -67,17 +97,45 @@ namespace SPR
 		{
 			for (int y = 0; y < m_height; ++y)
 			{
-				const int mineValue =
-					getMine(x - 1, y - 1)											   // up
-					+ getMine(x, y - 1) + getMine(x + 1, y - 1) + getMine(x - 1, y)	   // mid
-					+ getMine(x, y) + getMine(x + 1, y) + getMine(x - 1, y + 1)		   // down
-					+ getMine(x, y + 1) + getMine(x + 1, y + 1);
+				m_data[y * m_width + x].neighbours = minesAround(x, y);
+			}
+		}
+	}
 
-				GameField tempField = field(x, y);
-				tempField.neighbours = mineValue;
-				m_data[y * m_width + x] = tempField;
+	// Counts the cell itself too, which only matters for mines
+	int MineSweeper::minesAround(int x, int y) const
+	{
+		return getMine(x - 1, y - 1)											   // up
+			   + getMine(x, y - 1) + getMine(x + 1, y - 1) + getMine(x - 1, y)	   // mid
+			   + getMine(x, y) + getMine(x + 1, y) + getMine(x - 1, y + 1)		   // down
+			   + getMine(x, y + 1) + getMine(x + 1, y + 1);
+	}
+
+	void MineSweeper::recountMines()
+	{
+		m_totalMineNr = 0;
+		for (const GameField &cell : std::as_const(m_data))
+		{
+			m_totalMineNr += cell.mine ? 1 : 0;
+		}
+		populateNeighbourhood();
+		restoreCounters();
+	}
+
+	QPoint MineSweeper::firstNeighbourMismatch() const
+	{
+		for (int y = 0; y < m_height; ++y)
+		{
+			for (int x = 0; x < m_width; ++x)
+			{
+				const GameField &cell = fieldConst(x, y);
+				if (!cell.mine && cell.neighbours != minesAround(x, y))
+				{
+					return QPoint(x, y);
+				}
 			}
 		}
+		return QPoint(-1, -1);
 	}
 
 	int MineSweeper::getFlag(int x, int y) const
@@ -94,6 +152,65 @@ namespace SPR
 		return m_totalMineNr;
 	}
 
+	int MineSweeper::discoveredCount() const
+	{
+		return m_discoveredFieldsNr;
+	}
+
+	int MineSweeper::threeBV() const
+	{
+		std::vector< bool > reached(size(), false);
+		std::vector< long long > stack;
+		int clicks = 0;
+
+		for (long long id = 0; id < size(); ++id)
+		{
+			if (m_data[id].mine || m_data[id].neighbours != 0 || reached[id])
+			{
+				continue;
+			}
+
+			++clicks;	 // a new opening
+			reached[id] = true;
+			stack.push_back(id);
+			while (!stack.empty())
+			{
+				const long long current = stack.back();
+				stack.pop_back();
+				const int x = current % m_width;
+				const int y = current / m_width;
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						if (!isValidIndex(x + dx, y + dy))
+						{
+							continue;
+						}
+						const long long next = qint64(y + dy) * m_width + x + dx;
+						if (!reached[next])
+						{
+							reached[next] = true;
+							if (m_data[next].neighbours == 0)
+							{
+								stack.push_back(next);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		for (long long id = 0; id < size(); ++id)
+		{
+			if (!m_data[id].mine && !reached[id])
+			{
+				++clicks;
+			}
+		}
+		return clicks;
+	}
+
 	int MineSweeper::width() const
 	{
 		return m_width;
@@ -106,7 +223,12 @@ namespace SPR
 
 	long long MineSweeper::size() const
 	{
-		return m_width * m_height;
+		return qint64(m_width) * m_height;
+	}
+
+	bool MineSweeper::fitsBoard(qint64 width, qint64 height)
+	{
+		return width > 0 && height > 0 && width * height <= MAX_BOARD_CELLS;
 	}
 
 	int MineSweeper::countFlagsAround(int x, int y) const
@@ -176,6 +298,136 @@ namespace SPR
 		}
 	}
 
+	void MineSweeper::queueReveal(int x, int y)
+	{
+		if (isValidIndex(x, y))
+		{
+			m_revealQueue.push_back(y * m_width + x);
+		}
+	}
+
+	bool MineSweeper::queueChord(int x, int y)
+	{
+		if (!isValidIndex(x, y) || !getDiscovered(x, y) || getNeighbours(x, y) != countFlagsAround(x, y))
+		{
+			return false;
+		}
+
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				if (!getDiscovered(x + dx, y + dy))
+				{
+					queueReveal(x + dx, y + dy);
+				}
+			}
+		}
+		return true;
+	}
+
+	int MineSweeper::revealPending(int maxCells, QRect &changed)
+	{
+		int processed = 0;
+		while (!m_revealQueue.empty() && processed < maxCells)
+		{
+			const int id = m_revealQueue.front();
+			m_revealQueue.pop_front();
+			++processed;
+
+			GameField &cell = m_data[id];
+			if (cell.discovered != FIELD_NOT_VISITED || cell.disarmed != FIELD_NOT_VISITED)
+			{
+				continue;	 // queued twice, or flagged
+			}
+
+			cell.discovered = FIELD_VISITED;
+			m_discoveredFieldsNr++;
+
+			const int x = id % m_width;
+			const int y = id / m_width;
+			changed |= QRect(x, y, 1, 1);
+
+			if (cell.mine)
+			{
+				m_mineRevealed = true;
+				continue;
+			}
+
+			if (cell.neighbours == 0)
+			{
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						if (!getDiscovered(x + dx, y + dy) && fieldConst(x + dx, y + dy).disarmed == FIELD_NOT_VISITED)
+						{
+							m_revealQueue.push_back((y + dy) * m_width + x + dx);
+						}
+					}
+				}
+			}
+		}
+		return processed;
+	}
+
+	bool MineSweeper::hasPendingReveal() const
+	{
+		return !m_revealQueue.empty();
+	}
+
+	bool MineSweeper::mineRevealed() const
+	{
+		return m_mineRevealed;
+	}
+
+	QRect MineSweeper::applyMove(const Move &move)
+	{
+		const int x = move.row;
+		const int y = move.column;
+
+		QRect changed;
+		if (!isValidIndex(x, y))
+		{
+			return changed;
+		}
+
+		switch (move.type)
+		{
+		case Move::Reveal:
+		{
+			if (fieldConst(x, y).disarmed == FIELD_NOT_VISITED)
+			{
+				queueReveal(x, y);
+			}
+			break;
+		}
+
+		case Move::Flag:
+		{
+			if (!getDiscovered(x, y))
+			{
+				disarm(x, y);
+				changed = QRect(x, y, 1, 1);
+			}
+			break;
+		}
+
+		case Move::Chord:
+		case Move::Middle:
+		{
+			queueChord(x, y);	 // a middle click without matching flags only highlights
+			break;
+		}
+		}
+
+		while (hasPendingReveal())
+		{
+			revealPending(REVEAL_BATCH, changed);
+		}
+		return changed;
+	}
+
 	bool MineSweeper::isValidIndex(int x, int y) const
 	{
 		return (x >= 0 && x < m_width && y >= 0 && y < m_height);
@@ -195,6 +447,31 @@ namespace SPR
 		return m_data[id];
 	}
 
+	GameField* MineSweeper::cells()
+	{
+		return m_data.data();
+	}
+
+	const GameField* MineSweeper::cells() const
+	{
+		return m_data.constData();
+	}
+
+	void MineSweeper::restoreCounters()
+	{
+		m_discoveredFieldsNr = 0;
+		m_mineRevealed = false;
+		m_revealQueue.clear();
+		for (const GameField &cell : std::as_const(m_data))
+		{
+			if (cell.discovered != FIELD_NOT_VISITED)
+			{
+				++m_discoveredFieldsNr;
+				m_mineRevealed = m_mineRevealed || cell.mine;
+			}
+		}
+	}
+
 	void MineSweeper::markTemporary(int x, int y)
 	{
 		field(x, y).isHighlighted = true;
@@ -202,12 +479,9 @@ namespace SPR
 
 	void MineSweeper::clearHighlights()
 	{
-		for (int x = 0; x < width(); ++x)
+		for (GameField &cell : m_data)
 		{
-			for (int y = 0; y < height(); ++y)
-			{
-				field(x, y).isHighlighted = false;
-			}
+			cell.isHighlighted = false;
 		}
 	}
 }	 // namespace SPR
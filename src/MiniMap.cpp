@@ -0,0 +1,192 @@
+#include "include/MiniMap.h"
+
+namespace SPR
+{
+
+	MiniMap::MiniMap(QWidget *parent) : QWidget(parent), m_view(nullptr), m_model(nullptr), m_image(), m_cellsPerPixel(1), m_pixelScale(1),
+		m_rebuildScheduled(false)
+	{
+		setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+		setCursor(Qt::PointingHandCursor);
+	}
+
+	void MiniMap::setView(BoardView *view)
+	{
+		if (m_view)
+		{
+			disconnect(m_view, nullptr, this, nullptr);
+		}
+
+		m_view = view;
+
+		if (m_view)
+		{
+			connect(m_view, &BoardView::boardInvalidated, this, &MiniMap::scheduleRebuild);
+			connect(m_view->horizontalScrollBar(), &QScrollBar::valueChanged, this, [this]() { update(); });
+			connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() { update(); });
+		}
+
+		rebuild();
+	}
+
+	QSize MiniMap::sizeHint() const
+	{
+		return m_image.size() * m_pixelScale;
+	}
+
+	// New game, activate and zoom each invalidate the board; rebuild once for all of them
+	void MiniMap::scheduleRebuild()
+	{
+		if (!m_rebuildScheduled)
+		{
+			m_rebuildScheduled = true;
+			QTimer::singleShot(0, this, &MiniMap::rebuild);
+		}
+	}
+
+	void MiniMap::rebuild()
+	{
+		m_rebuildScheduled = false;
+
+		TableState *model = m_view ? m_view->model() : nullptr;
+		if (model != m_model)
+		{
+			if (m_model)
+			{
+				disconnect(m_model, nullptr, this, nullptr);
+			}
+			m_model = model;
+			if (m_model)
+			{
+				connect(m_model, &TableState::dataChanged, this, &MiniMap::onDataChanged);
+			}
+		}
+
+		const int rows = m_model ? m_model->rowCount() : 0;
+		const int columns = m_model ? m_model->columnCount() : 0;
+		if (rows == 0 || columns == 0)
+		{
+			m_image = QImage();
+			updateGeometry();
+			update();
+			return;
+		}
+
+		const int longest = qMax(rows, columns);
+		m_cellsPerPixel = (longest + MINIMAP_SIZE - 1) / MINIMAP_SIZE;
+		m_pixelScale = qMax(1, MINIMAP_SIZE / longest);
+
+		const QSize blocks((columns + m_cellsPerPixel - 1) / m_cellsPerPixel, (rows + m_cellsPerPixel - 1) / m_cellsPerPixel);
+		if (m_image.size() != blocks)
+		{
+			m_image = QImage(blocks, QImage::Format_RGB32);
+			updateGeometry();
+		}
+
+		updateBlocks(m_image.rect());
+	}
+
+	void MiniMap::paintEvent(QPaintEvent * /* event */)
+	{
+		if (m_image.isNull())
+		{
+			return;
+		}
+
+		QPainter painter(this);
+		painter.scale(m_pixelScale, m_pixelScale);
+		painter.drawImage(0, 0, m_image);
+
+		const QRect cells = m_view->visibleCells();
+		const QRectF frame(QPointF(qreal(cells.left()) / m_cellsPerPixel, qreal(cells.top()) / m_cellsPerPixel),
+						   QSizeF(qreal(cells.width()) / m_cellsPerPixel, qreal(cells.height()) / m_cellsPerPixel));
+		painter.setPen(QPen(Qt::red, 0));
+		painter.drawRect(frame);
+	}
+
+	void MiniMap::mousePressEvent(QMouseEvent *event)
+	{
+		centerViewAt(event->pos());
+	}
+
+	void MiniMap::mouseMoveEvent(QMouseEvent *event)
+	{
+		if (event->buttons() & Qt::LeftButton)
+		{
+			centerViewAt(event->pos());
+		}
+	}
+
+	void MiniMap::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+	{
+		if (m_image.isNull() || !topLeft.isValid() || !bottomRight.isValid())
+		{
+			return;
+		}
+
+		// The image can still be sized for a larger board until the queued rebuild() runs
+		const QRect blocks(QPoint(topLeft.column() / m_cellsPerPixel, topLeft.row() / m_cellsPerPixel),
+						   QPoint(bottomRight.column() / m_cellsPerPixel, bottomRight.row() / m_cellsPerPixel));
+		const QRect current(0,
+							0,
+							(m_model->columnCount() + m_cellsPerPixel - 1) / m_cellsPerPixel,
+							(m_model->rowCount() + m_cellsPerPixel - 1) / m_cellsPerPixel);
+		updateBlocks(blocks & m_image.rect() & current);
+	}
+
+	void MiniMap::updateBlocks(const QRect &blocks)
+	{
+		for (int blockRow = blocks.top(); blockRow <= blocks.bottom(); ++blockRow)
+		{
+			QRgb *line = reinterpret_cast< QRgb * >(m_image.scanLine(blockRow));
+			for (int blockColumn = blocks.left(); blockColumn <= blocks.right(); ++blockColumn)
+			{
+				line[blockColumn] = blockColor(blockRow, blockColumn);
+			}
+		}
+		update();
+	}
+
+	QRgb MiniMap::blockColor(int blockRow, int blockColumn) const
+	{
+		const int firstRow = blockRow * m_cellsPerPixel;
+		const int firstColumn = blockColumn * m_cellsPerPixel;
+		const int rows = qMin(m_cellsPerPixel, m_model->rowCount() - firstRow);
+		const int columns = qMin(m_cellsPerPixel, m_model->columnCount() - firstColumn);
+		const int rowSamples = qMin(rows, MINIMAP_SAMPLES);
+		const int columnSamples = qMin(columns, MINIMAP_SAMPLES);
+		if (rowSamples <= 0 || columnSamples <= 0)
+		{
+			return qRgb(0, 0, 0);	 // past the edge of a board that shrank
+		}
+
+		int red = 0, green = 0, blue = 0;
+		for (int i = 0; i < rowSamples; ++i)
+		{
+			const int row = firstRow + (2 * i + 1) * rows / (2 * rowSamples);
+			for (int j = 0; j < columnSamples; ++j)
+			{
+				const QRgb color = m_view->flatColorAt(row, firstColumn + (2 * j + 1) * columns / (2 * columnSamples));
+				red += qRed(color);
+				green += qGreen(color);
+				blue += qBlue(color);
+			}
+		}
+
+		const int samples = rowSamples * columnSamples;
+		return qRgb(red / samples, green / samples, blue / samples);
+	}
+
+	void MiniMap::centerViewAt(const QPoint &pos)
+	{
+		if (m_image.isNull())
+		{
+			return;
+		}
+
+		const int column = pos.x() * m_cellsPerPixel / m_pixelScale;
+		const int row = pos.y() * m_cellsPerPixel / m_pixelScale;
+		m_view->centerOn(row, column);
+	}
+
+}	 // namespace SPR
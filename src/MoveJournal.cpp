@@ -0,0 +1,199 @@
+#include "include/MoveJournal.h"
+
+namespace SPR
+{
+
+	MoveJournal::MoveJournal(const QString &filepath, QObject *parent) :
+		QObject(parent), m_path(filepath), m_file(filepath), m_base(0), m_sequence(0), m_checkpointed(0), m_pendingCheckpoints(), m_tail()
+	{
+	}
+
+	QString MoveJournal::path() const
+	{
+		return m_path;
+	}
+
+	qint64 MoveJournal::sequence() const
+	{
+		return m_sequence;
+	}
+
+	// A new game: the log starts empty, past every checkpoint taken so far
+	bool MoveJournal::restart()
+	{
+		m_base = ++m_sequence;
+		m_checkpointed = m_base;
+		m_tail.clear();
+		return rewrite();
+	}
+
+	void MoveJournal::discard()
+	{
+		m_file.close();
+		QFile::remove(m_path);
+		m_tail.clear();
+	}
+
+	bool MoveJournal::append(const Move &move, qint8 flag)
+	{
+		if (!m_file.isOpen())
+		{
+			return false;
+		}
+
+		Entry entry;
+		entry.sequence = ++m_sequence;
+		entry.move = move;
+		entry.flag = flag;
+		m_tail.append(entry);
+
+		const QByteArray record = encode(entry);
+		const bool written = m_file.write(record) == record.size() && m_file.flush();
+
+		if (m_pendingCheckpoints.empty() && m_sequence - m_checkpointed >= JOURNAL_CHECKPOINT_MOVES)
+		{
+			emit checkpointDue();
+		}
+		return written;
+	}
+
+	qint64 MoveJournal::beginCheckpoint()
+	{
+		m_pendingCheckpoints.push_back(m_sequence);
+		return m_sequence;
+	}
+
+	void MoveJournal::endCheckpoint(bool ok)
+	{
+		if (m_pendingCheckpoints.empty())
+		{
+			return;
+		}
+
+		const qint64 covered = m_pendingCheckpoints.front();
+		m_pendingCheckpoints.pop_front();
+		if (!ok || covered < m_base)
+		{
+			return;	   // failed, or taken before the log was restarted
+		}
+
+		m_checkpointed = covered;
+		m_tail.erase(std::remove_if(m_tail.begin(), m_tail.end(), [covered](const Entry &entry) { return entry.sequence <= covered; }),
+					 m_tail.end());
+		rewrite();
+	}
+
+	int MoveJournal::replay(MineSweeper &board, qint64 checkpointSequence, QVector< Move > *applied)
+	{
+		m_file.close();
+		m_tail.clear();
+		m_base = checkpointSequence;
+		m_sequence = checkpointSequence;
+		m_checkpointed = checkpointSequence;
+
+		int count = 0;
+		QFile file(m_path);
+		if (file.open(QIODevice::ReadOnly))
+		{
+			QDataStream in(&file);
+			quint32 magic = 0;
+			quint16 version = 0;
+			qint64 base = 0;
+			in >> magic >> version >> base;
+
+			// A log begun after the checkpoint belongs to a newer game
+			const bool usable = in.status() == QDataStream::Ok && magic == MAGIC && version == VERSION && base <= checkpointSequence;
+			const int recordSize = encode(Entry()).size();
+			while (usable)
+			{
+				const QByteArray record = file.read(recordSize);
+				if (record.size() != recordSize)
+				{
+					break;
+				}
+
+				QDataStream entryIn(record);
+				Entry entry;
+				quint32 stored = 0;
+				entryIn >> entry.sequence >> entry.move >> entry.flag >> stored;
+				if (stored != quint32(crc32(0L, reinterpret_cast< const Bytef * >(record.constData()), recordSize - sizeof(quint32))))
+				{
+					break;	  // torn or damaged tail
+				}
+
+				if (entry.sequence > checkpointSequence)
+				{
+					apply(board, entry);
+					m_tail.append(entry);
+					m_sequence = entry.sequence;
+					if (applied)
+					{
+						applied->append(entry.move);
+					}
+					++count;
+				}
+			}
+
+			if (usable)
+			{
+				m_base = base;
+			}
+			file.close();
+		}
+
+		rewrite();	  // drops whatever followed the last good entry
+		return count;
+	}
+
+	QByteArray MoveJournal::encode(const Entry &entry)
+	{
+		QByteArray record;
+		QDataStream out(&record, QIODevice::WriteOnly);
+		out << entry.sequence << entry.move << entry.flag;
+		out << quint32(crc32(0L, reinterpret_cast< const Bytef * >(record.constData()), record.size()));
+		return record;
+	}
+
+	// The session's cells may already hold the move, as their pages reach the disk in any
+	// order: a known flag state is set rather than cycled once more
+	void MoveJournal::apply(MineSweeper &board, const Entry &entry)
+	{
+		const Move &move = entry.move;
+		if (move.type == Move::Flag && entry.flag >= FIELD_NOT_VISITED && entry.flag <= PLAYER_NOT_SURE &&
+			QRect(0, 0, board.width(), board.height()).contains(move.row, move.column))
+		{
+			if (!board.getDiscovered(move.row, move.column))
+			{
+				board.field(move.row, move.column).disarmed = entry.flag;
+			}
+			return;
+		}
+		board.applyMove(move);
+	}
+
+	// Replaces the log atomically with the header and the entries still uncovered
+	bool MoveJournal::rewrite()
+	{
+		m_file.close();
+
+		QSaveFile file(m_path);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
+
+		QDataStream out(&file);
+		out << MAGIC << VERSION << m_base;
+		for (const Entry &entry : m_tail)
+		{
+			file.write(encode(entry));
+		}
+
+		if (!file.commit())
+		{
+			return false;
+		}
+		return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+	}
+
+}	 // namespace SPR
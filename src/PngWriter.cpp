@@ -0,0 +1,152 @@
+#include "include/PngWriter.h"
+
+namespace SPR
+{
+
+	PngWriter::PngWriter(QIODevice *device, int compressionLevel) :
+		m_device(device), m_stream(), m_row(), m_out(), m_background(qRgb(255, 255, 255)), m_compressionLevel(compressionLevel), m_width(0), m_height(0), m_rowsWritten(0),
+		m_open(false)
+	{
+	}
+
+	PngWriter::~PngWriter()
+	{
+		if (m_open)
+		{
+			deflateEnd(&m_stream);
+		}
+	}
+
+	bool PngWriter::begin(int width, int height)
+	{
+		if (m_open || width <= 0 || height <= 0)
+		{
+			return false;
+		}
+
+		m_stream = z_stream();
+		if (deflateInit(&m_stream, m_compressionLevel) != Z_OK)
+		{
+			return false;
+		}
+
+		m_open = true;
+		m_width = width;
+		m_height = height;
+		m_rowsWritten = 0;
+		m_row.resize(1 + 3 * qsizetype(width));
+		m_out.resize(64 * 1024);
+
+		static const char signature[] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n' };
+		if (m_device->write(signature, sizeof(signature)) != sizeof(signature))
+		{
+			return false;
+		}
+
+		QByteArray header(13, '\0');
+		qToBigEndian< quint32 >(width, header.data());
+		qToBigEndian< quint32 >(height, header.data() + 4);
+		header[8] = 8;	  // bit depth
+		header[9] = 2;	  // truecolour
+		return writeChunk("IHDR", header);
+	}
+
+	// Expects rows exactly as wide as the image
+	bool PngWriter::writeRows(const QImage &rows)
+	{
+		if (!m_open || rows.width() != m_width || m_rowsWritten + rows.height() > m_height)
+		{
+			return false;
+		}
+
+		const QImage source =
+			rows.format() == QImage::Format_ARGB32_Premultiplied ? rows : rows.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		for (int y = 0; y < source.height(); ++y)
+		{
+			const QRgb *pixels = reinterpret_cast< const QRgb * >(source.constScanLine(y));
+			uchar *out = reinterpret_cast< uchar * >(m_row.data());
+			*out++ = 0;	   // filter: none
+			for (int x = 0; x < m_width; ++x)
+			{
+				const QRgb pixel = pixels[x];
+				const int coverage = 255 - qAlpha(pixel);
+				*out++ = qRed(pixel) + (qRed(m_background) * coverage + 127) / 255;
+				*out++ = qGreen(pixel) + (qGreen(m_background) * coverage + 127) / 255;
+				*out++ = qBlue(pixel) + (qBlue(m_background) * coverage + 127) / 255;
+			}
+
+			m_stream.next_in = reinterpret_cast< Bytef * >(m_row.data());
+			m_stream.avail_in = m_row.size();
+			if (!deflateInto(Z_NO_FLUSH))
+			{
+				return false;
+			}
+		}
+
+		m_rowsWritten += source.height();
+		return true;
+	}
+
+	bool PngWriter::finish()
+	{
+		if (!m_open || m_rowsWritten != m_height)
+		{
+			return false;
+		}
+
+		const bool deflated = deflateInto(Z_FINISH);
+		deflateEnd(&m_stream);
+		m_open = false;
+
+		return deflated && writeChunk("IEND", QByteArray());
+	}
+
+	void PngWriter::setBackground(QRgb color)
+	{
+		m_background = color;
+	}
+
+	int PngWriter::rowsWritten() const
+	{
+		return m_rowsWritten;
+	}
+
+	bool PngWriter::writeChunk(const char *type, const QByteArray &data)
+	{
+		char length[4];
+		qToBigEndian< quint32 >(data.size(), length);
+
+		uLong crc = crc32(0L, Z_NULL, 0);
+		crc = crc32(crc, reinterpret_cast< const Bytef * >(type), 4);
+		crc = crc32(crc, reinterpret_cast< const Bytef * >(data.constData()), data.size());
+		char checksum[4];
+		qToBigEndian< quint32 >(crc, checksum);
+
+		return m_device->write(length, 4) == 4 && m_device->write(type, 4) == 4 && m_device->write(data) == data.size()
+			&& m_device->write(checksum, 4) == 4;
+	}
+
+	bool PngWriter::deflateInto(int flush)
+	{
+		int result = Z_OK;
+		do
+		{
+			m_stream.next_out = reinterpret_cast< Bytef * >(m_out.data());
+			m_stream.avail_out = m_out.size();
+			result = deflate(&m_stream, flush);
+			if (result == Z_STREAM_ERROR)
+			{
+				return false;
+			}
+
+			const int produced = m_out.size() - m_stream.avail_out;
+			if (produced > 0 && !writeChunk("IDAT", m_out.left(produced)))
+			{
+				return false;
+			}
+		} while (m_stream.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+
+		return true;
+	}
+
+}	 // namespace SPR
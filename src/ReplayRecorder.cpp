@@ -0,0 +1,87 @@
+#include "include/ReplayRecorder.h"
+
+namespace SPR
+{
+
+	ReplayRecorder::ReplayRecorder(QObject *parent) :
+		QObject(parent), m_model(nullptr), m_log(), m_clock(), m_offset(0), m_recording(false)
+	{
+	}
+
+	void ReplayRecorder::attach(BoardView *view, TableState *model)
+	{
+		m_model = model;
+		connect(model, &TableState::gameStarted, this, &ReplayRecorder::onGameStarted);
+		connect(view, &BoardView::clicked, this, [this](const QModelIndex &index) { record(Move::Reveal, index); });
+		connect(view, &BoardView::rightClicked, this, [this](const QModelIndex &index) { record(Move::Flag, index); });
+		connect(view, &BoardView::bothClicked, this, [this](const QModelIndex &index) { record(Move::Chord, index); });
+		connect(view, &BoardView::middleClicked, this, [this](const QModelIndex &index) { record(Move::Middle, index); });
+	}
+
+	bool ReplayRecorder::isRecording() const
+	{
+		return m_recording;
+	}
+
+	const MineSweeper &ReplayRecorder::startBoard() const
+	{
+		return m_log.start;
+	}
+
+	const QVector< Move > &ReplayRecorder::moves() const
+	{
+		return m_log.moves;
+	}
+
+	const MoveLog &ReplayRecorder::log() const
+	{
+		return m_log;
+	}
+
+	void ReplayRecorder::clear()
+	{
+		m_recording = false;
+		m_log = MoveLog();
+	}
+
+	// Flags placed before the first reveal are part of the start board, not moves
+	void ReplayRecorder::record(Move::Type type, const QModelIndex &index)
+	{
+		if (!m_recording || !index.isValid())
+		{
+			return;
+		}
+
+		Move move;
+		move.type = type;
+		move.row = index.row();
+		move.column = index.column();
+		move.msec = m_offset + m_clock.elapsed();
+		m_log.moves.append(move);
+		emit recorded(move);
+	}
+
+	void ReplayRecorder::resume(const MoveLog &log)
+	{
+		if (!log.start.isGenerated())
+		{
+			onGameStarted();
+			return;
+		}
+
+		m_log = log;
+		m_offset = log.moves.isEmpty() ? 0 : log.moves.last().msec;
+		m_clock.start();
+		m_recording = true;
+	}
+
+	void ReplayRecorder::onGameStarted()
+	{
+		m_log.start = m_model->getMineSweeper();
+		m_log.moves.clear();
+		m_offset = 0;
+		m_clock.start();
+		m_recording = true;
+	}
+
+}	 // namespace SPR
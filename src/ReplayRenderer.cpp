@@ -0,0 +1,100 @@
+#include "include/ReplayRenderer.h"
+
+namespace SPR
+{
+
+	ReplayRenderer::ReplayRenderer(const MineSweeper &start, const QVector< Move > &moves, bool debug, int cellSize) :
+		m_start(start), m_moves(moves), m_renderer(start, false, debug, cellSize), m_framebuffer(), m_gameOver(false)
+	{
+	}
+
+	int ReplayRenderer::frameCount() const
+	{
+		return m_moves.size() + 1;
+	}
+
+	QString ReplayRenderer::frameName(int number)
+	{
+		return QString("frame_%1.png").arg(number, 6, 10, QChar('0'));
+	}
+
+	bool ReplayRenderer::renderTo(const QString &directory)
+	{
+		QDir dir(directory);
+		QFile playlist(dir.filePath("replay.ffconcat"));
+		if (!dir.mkpath(".") || !playlist.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			return false;
+		}
+
+		QTextStream out(&playlist);
+		out << "ffconcat version 1.0\n";
+
+		MineSweeper board = m_start;
+		m_renderer.updateCells(m_start, QRect(0, 0, m_renderer.columnCount(), m_renderer.rowCount()));
+		m_renderer.setGameOver(false);
+		m_framebuffer = m_renderer.render();
+		m_gameOver = false;
+
+		// Bounded so a long game does not queue every frame in memory at once
+		const int maxInFlight = 2 * qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+		QList< QFuture< bool > > pending;
+		bool saved = true;
+
+		for (int frame = 0; frame < frameCount(); ++frame)
+		{
+			if (frame > 0)
+			{
+				advance(board, m_moves[frame - 1]);
+			}
+
+			// The framebuffer detaches on the next paint, so the encoder owns this copy
+			const QImage image = m_framebuffer;
+			const QString path = dir.filePath(frameName(frame));
+			pending.append(QtConcurrent::run([image, path]() { return image.save(path, "PNG"); }));
+			if (pending.size() > maxInFlight)
+			{
+				saved = pending.takeFirst().result() && saved;
+			}
+
+			// A frame lasts until the next move, with idle stretches cut short
+			qint64 delay = REPLAY_MAX_DELAY_MS;
+			if (frame < m_moves.size())
+			{
+				const qint64 shownAt = frame > 0 ? m_moves[frame - 1].msec : 0;
+				delay = qBound< qint64 >(REPLAY_MIN_DELAY_MS, m_moves[frame].msec - shownAt, REPLAY_MAX_DELAY_MS);
+			}
+			out << "file '" << frameName(frame) << "'\nduration " << delay / 1000.0 << "\n";
+		}
+
+		for (QFuture< bool > &future : pending)
+		{
+			saved = future.result() && saved;
+		}
+		return saved && out.status() == QTextStream::Ok;
+	}
+
+	void ReplayRenderer::advance(MineSweeper &board, const Move &move)
+	{
+		const QRect changed = board.applyMove(move);
+		if (changed.isNull())
+		{
+			return;
+		}
+
+		// applyMove reports board (x, y); the renderer wants x as column and y as row
+		const QRect cells(changed.y(), changed.x(), changed.height(), changed.width());
+		m_renderer.updateCells(board, cells);
+
+		if (!m_gameOver && (board.mineRevealed() || board.checkWinCondition()))
+		{
+			m_gameOver = true;
+			m_renderer.setGameOver(true);
+			m_renderer.renderCells(m_framebuffer, QRect(0, 0, m_renderer.columnCount(), m_renderer.rowCount()), QPoint(0, 0));
+			return;
+		}
+
+		m_renderer.renderCells(m_framebuffer, cells, QPoint(0, 0));
+	}
+
+}	 // namespace SPR
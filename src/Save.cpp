@@ -4,8 +4,16 @@ namespace SPR
 {
 
 	Save::Save(MineSweeper& model, QTimer& timer, Preferences& prefs, QObject* parent) :
-		QObject(parent), _model(model), _timer(timer), _prefs(prefs), _parent(parent), _topWidget(nullptr)
+		QObject(parent), _model(model), _timer(timer), _prefs(prefs), _parent(parent), _topWidget(nullptr), m_writer(), m_pendingSaves(0),
+		m_loadedSequence(0), m_moveLog(nullptr), m_loadedLog(), m_session(FileFormat::SESSION_FILE), m_index()
 	{
+		m_writer.setMaxThreadCount(1);
+		connect(&m_session, &SessionFile::flushed, this, &Save::quickSaveFlushed);
+	}
+
+	Save::~Save()
+	{
+		waitForSaves();
 	}
 
 	bool Save::saveGame()
@@ -14,125 +22,287 @@ namespace SPR
 			qobject_cast< QWidget* >(_parent),
 			tr("Save Game"),
 			QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
-			tr("Minesweeper Saves (*.ini)"));
+			tr("Minesweeper Saves (*.sav)"));
 
 		if (filename.isEmpty())
 		{
 			return false;
 		}
 
-		return serialize(filename);
+		saveAsync(filename);
+		return true;
 	}
 
 	bool Save::loadGame()
 	{
-		QString filename = QFileDialog::getOpenFileName(
-			qobject_cast< QWidget* >(_parent),
-			tr("Load Game"),
-			QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
-			tr("Minesweeper Saves (*.ini)"));
+		if (!m_index)
+		{
+			m_index = std::make_unique< SaveIndex >(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation));
+		}
+		const QString filename = SaveBrowser::getSaveFile(*m_index, qobject_cast< QWidget* >(_parent));
 
 		if (filename.isEmpty())
 		{
 			return false;
 		}
 
+		waitForSaves();
 		return deserialize(filename);
 	}
 
-	bool Save::quickSave()
+	// Synchronous: the cells go into the mapping here, the disk write follows on a worker
+	bool Save::quickSave(qint64 journalSequence)
 	{
-		return serialize(quickSavePath());
+		const bool first = !m_session.isOpen();
+		const bool ok = m_session.sync(_model, _topWidget->getTime(), _timer.isActive(), journalSequence);
+		if (ok && first)
+		{
+			QFile::remove(FileFormat::LEGACY_QUICKSAVE_FILE);	 // superseded by the session
+		}
+		return ok;
+	}
+
+	void Save::flushQuickSave()
+	{
+		m_session.flushDurably();
 	}
 
 	bool Save::quickLoad()
 	{
+		waitForSaves();
 		return deserialize(quickSavePath());
 	}
 
+	void Save::discardQuickSave()
+	{
+		m_session.discard();
+		QFile::remove(FileFormat::LEGACY_QUICKSAVE_FILE);
+	}
+
+	void Save::markChanged(const QRect& cells)
+	{
+		m_session.markChanged(cells);
+	}
+
+	void Save::markAllChanged()
+	{
+		m_session.markAllChanged();
+	}
+
+	void Save::syncTime()
+	{
+		m_session.syncTime(_topWidget->getTime(), _timer.isActive());
+	}
+
+	void Save::saveAsync(const QString& filepath, qint64 journalSequence)
+	{
+		MineSweeper snapshot = _model;
+		const int elapsed = _topWidget->getTime();
+		const bool running = _timer.isActive();
+		const MoveLog log = m_moveLog ? *m_moveLog : MoveLog();
+
+		m_pendingSaves.ref();
+		QtConcurrent::run(&m_writer,
+						  [this, snapshot, elapsed, running, journalSequence, log, filepath]() mutable
+						  {
+							  // A flood fill the game is still slicing is finished on the copy; a
+							  // loaded board drops its reveal queue, so the file must not hold half
+							  QRect changed;
+							  while (snapshot.hasPendingReveal())
+							  {
+								  snapshot.revealPending(REVEAL_BATCH, changed);
+							  }
+
+							  const bool ok = writeFile(filepath,
+														snapshot,
+														elapsed,
+														running,
+														journalSequence,
+														log,
+														[this, &filepath](int percent) { emit saveProgress(filepath, percent); });
+							  m_pendingSaves.deref();
+							  emit saveFinished(filepath, ok);
+						  });
+	}
+
+	bool Save::isSaving() const
+	{
+		return m_pendingSaves.loadAcquire() > 0;
+	}
+
+	void Save::waitForSaves()
+	{
+		m_writer.waitForDone();
+	}
+
+	// The INI quick save of older builds is still offered until a session replaces it
 	QString Save::quickSavePath()
 	{
-		return FileFormat::QUICKSAVE_FILE;
+		if (!QFile::exists(FileFormat::SESSION_FILE) && QFile::exists(FileFormat::LEGACY_QUICKSAVE_FILE))
+		{
+			return FileFormat::LEGACY_QUICKSAVE_FILE;
+		}
+		return FileFormat::SESSION_FILE;
 	}
 
-	bool Save::serialize(const QString& filepath)
+	QString Save::journalPath()
 	{
-		QSettings settings(filepath, QSettings::IniFormat);
+		return FileFormat::JOURNAL_FILE;
+	}
 
-		settings.beginGroup("Game");
-		settings.setValue("width", _model.width());
-		settings.setValue("height", _model.height());
-		settings.setValue("mine", _model.totalMineNr());
-		settings.endGroup();
+	qint64 Save::loadedJournalSequence() const
+	{
+		return m_loadedSequence;
+	}
+
+	bool Save::serialize(const QString& filepath)
+	{
+		return writeFile(filepath, _model, _topWidget->getTime(), _timer.isActive(), 0, m_moveLog ? *m_moveLog : MoveLog());
+	}
 
-		settings.beginGroup("Timer");
-		settings.setValue("elapsed", _topWidget->getTime());
-		settings.setValue("running", _timer.isActive());
-		settings.endGroup();
+	bool Save::writeFile(const QString& filepath,
+						 const MineSweeper& board,
+						 int elapsed,
+						 bool timerRunning,
+						 qint64 journalSequence,
+						 const MoveLog& log,
+						 const std::function< void(int) >& progress)
+	{
+		QSaveFile file(filepath);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
 
-		settings.beginGroup("Board");
-		for (int y = 0; y < _model.height(); ++y)
+		if (SaveFormat::reproduces(log, board))
 		{
-			for (int x = 0; x < _model.width(); ++x)
+			if (!SaveFormat::writeMoves(&file, board, log, elapsed, timerRunning, journalSequence))
 			{
-				settings.beginGroup(QString("Cell_%1_%2").arg(x).arg(y));
-				const GameField& field = _model.field(x, y);
-				settings.setValue("mine", field.mine);
-				settings.setValue("discovered", field.discovered);
-				settings.setValue("disarmed", field.disarmed);
-				settings.setValue("neighbours", field.neighbours);
-				settings.endGroup();
+				file.cancelWriting();
+				return false;
 			}
+			return file.commit();
 		}
-		settings.endGroup();
 
-		return settings.status() == QSettings::NoError;
+		const SaveFormat::Encoding encoding = board.size() >= SAVE_RAW_CELLS ? SaveFormat::Records : SaveFormat::Planes;
+		if (!SaveFormat::write(&file, board, elapsed, timerRunning, encoding, journalSequence, progress))
+		{
+			file.cancelWriting();
+			return false;
+		}
+		return file.commit();	 // syncs, then renames over the target
 	}
 
+	// Session files and binary saves are recognised by their magic; anything else goes to
+	// the INI reader
 	bool Save::deserialize(const QString& filepath)
 	{
-		QSettings settings(filepath, QSettings::IniFormat);
+		MineSweeper session;
+		SaveHeader sessionHeader;
+		if (SessionFile::load(filepath, session, sessionHeader))
+		{
+			_model = std::move(session);
+			m_loadedLog = MoveLog();
+			m_loadedSequence = sessionHeader.journalSequence;
+			applyLoaded(sessionHeader.width, sessionHeader.height, sessionHeader.mines, sessionHeader.elapsed);
+			return true;
+		}
 
-		if (!settings.contains("Game/width"))
+		QFile file(filepath);
+		if (file.open(QIODevice::ReadOnly) && SaveFormat::isBinary(&file))
+		{
+			MineSweeper loaded;
+			SaveHeader header;
+			MoveLog log;
+			if (!SaveFormat::verify(&file) || !file.seek(0) || !SaveFormat::read(&file, loaded, header, &log))
+			{
+				return false;
+			}
+
+			_model = std::move(loaded);
+			m_loadedLog = std::move(log);
+			m_loadedSequence = header.journalSequence;
+			applyLoaded(header.width, header.height, header.mines, header.elapsed);
+			return true;
+		}
+		file.close();
+
+		return deserializeIni(filepath);
+	}
+
+	bool Save::readHeader(const QString& filepath, SaveHeader& header)
+	{
+		if (SessionFile::readHeader(filepath, header))
+		{
+			return true;
+		}
+
+		QFile file(filepath);
+		if (!file.open(QIODevice::ReadOnly))
 		{
 			return false;
 		}
+		if (SaveFormat::isBinary(&file))
+		{
+			return SaveFormat::readHeader(&file, header);
+		}
 
-		int width = settings.value("Game/width").toInt();
-		int height = settings.value("Game/height").toInt();
-		int mine = settings.value("Game/mine").toInt();
+		MineSweeper board;
+		return LegacyIniReader::read(&file, board, header, false);
+	}
 
-		_model.reset(width, height, mine);
+	bool Save::verify(const QString& filepath)
+	{
+		QFile file(filepath);
+		return file.open(QIODevice::ReadOnly) && SaveFormat::isBinary(&file) && SaveFormat::verify(&file);
+	}
 
-		settings.beginGroup("Board");
-		for (int y = 0; y < height; ++y)
+	int Save::getElapsedTime(const QString& filepath) const
+	{
+		SaveHeader header;
+		return readHeader(filepath, header) ? header.elapsed : 0;
+	}
+
+	// Format written before the binary one: a Cell_x_y group per cell
+	bool Save::deserializeIni(const QString& filepath)
+	{
+		QFile file(filepath);
+		MineSweeper loaded;
+		SaveHeader header;
+		if (!file.open(QIODevice::ReadOnly) || !LegacyIniReader::read(&file, loaded, header, false))
 		{
-			for (int x = 0; x < width; ++x)
-			{
-				settings.beginGroup(QString("Cell_%1_%2").arg(x).arg(y));
-				GameField& field = _model.field(x, y);
-				field.mine = settings.value("mine").toInt();
-				field.discovered = settings.value("discovered").toInt();
-				field.disarmed = settings.value("disarmed").toInt();
-				field.neighbours = settings.value("neighbours").toInt();
-				settings.endGroup();
-			}
+			return false;
 		}
-		settings.endGroup();
 
-		int elapsed = settings.value("Timer/elapsed").toInt();
+		_model = std::move(loaded);
+		m_loadedSequence = 0;
+		m_loadedLog = MoveLog();
+		applyLoaded(header.width, header.height, header.mines, header.elapsed);
+		return true;
+	}
 
+	void Save::applyLoaded(int width, int height, int mine, int elapsed)
+	{
 		_topWidget->setTimer(elapsed);
 
 		_prefs.width = width;
 		_prefs.height = height;
 		_prefs.mine = mine;
-
-		return true;
 	}
 
 	void Save::setTopWidget(TopWidget* topWidget)
 	{
 		_topWidget = topWidget;
 	}
+
+	void Save::setMoveLog(const MoveLog* log)
+	{
+		m_moveLog = log;
+	}
+
+	// Start board and moves of the last seed-and-moves save loaded, empty for full saves
+	const MoveLog& Save::loadedLog() const
+	{
+		return m_loadedLog;
+	}
 }	 // namespace SPR
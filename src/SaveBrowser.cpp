@@ -0,0 +1,87 @@
+#include "include/SaveBrowser.h"
+
+namespace SPR
+{
+
+	SaveBrowser::SaveBrowser(SaveIndex &index, QWidget *parent) : QDialog(parent), m_index(index)
+	{
+		QVBoxLayout *layout = new QVBoxLayout(this);
+
+		m_list = new QListWidget(this);
+		m_list->setViewMode(QListView::IconMode);
+		m_list->setIconSize(QSize(THUMBNAIL_SIZE, THUMBNAIL_SIZE));
+		m_list->setGridSize(QSize(THUMBNAIL_SIZE * 3, THUMBNAIL_SIZE * 2));
+		m_list->setResizeMode(QListView::Adjust);
+		m_list->setMovement(QListView::Static);
+		m_list->setUniformItemSizes(true);
+		layout->addWidget(m_list);
+
+		m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Open | QDialogButtonBox::Cancel, Qt::Horizontal, this);
+		QPushButton *otherButton = m_buttonBox->addButton(tr("Other File..."), QDialogButtonBox::ActionRole);
+		layout->addWidget(m_buttonBox);
+
+		connect(m_buttonBox, &QDialogButtonBox::accepted, this, &SaveBrowser::accept);
+		connect(m_buttonBox, &QDialogButtonBox::rejected, this, &SaveBrowser::reject);
+		connect(otherButton, &QPushButton::clicked, this, &SaveBrowser::browse);
+		connect(m_list, &QListWidget::itemDoubleClicked, this, &SaveBrowser::accept);
+		connect(&m_index, &SaveIndex::updated, this, &SaveBrowser::populate, Qt::QueuedConnection);
+
+		setWindowTitle(tr("Load Game"));
+		resize(THUMBNAIL_SIZE * 10, THUMBNAIL_SIZE * 7);
+		populate();
+	}
+
+	SaveBrowser::~SaveBrowser() = default;
+
+	QString SaveBrowser::getSaveFile(SaveIndex &index, QWidget *parent)
+	{
+		SaveBrowser dialog(index, parent);
+		index.refresh();
+
+		if (dialog.exec() != QDialog::Accepted)
+		{
+			return QString();
+		}
+		if (!dialog.m_selected.isEmpty())
+		{
+			return dialog.m_selected;
+		}
+
+		QListWidgetItem *item = dialog.m_list->currentItem();
+		return item ? QDir(index.directory()).filePath(item->data(Qt::UserRole).toString()) : QString();
+	}
+
+	void SaveBrowser::populate()
+	{
+		const QString current = m_list->currentItem() ? m_list->currentItem()->data(Qt::UserRole).toString() : QString();
+		m_list->clear();
+
+		for (const SaveIndex::Entry &entry : m_index.entries())
+		{
+			if (!entry.readable)
+			{
+				continue;
+			}
+
+			const SaveHeader &header = entry.header;
+			const QString details =
+				tr("%1 x %2, %3 mines, %4 s").arg(header.width).arg(header.height).arg(header.mines).arg(header.elapsed);
+			QListWidgetItem *item = new QListWidgetItem(QIcon(QPixmap::fromImage(entry.thumbnail)), entry.fileName + "\n" + details, m_list);
+			item->setData(Qt::UserRole, entry.fileName);
+			if (entry.fileName == current)
+			{
+				m_list->setCurrentItem(item);
+			}
+		}
+	}
+
+	void SaveBrowser::browse()
+	{
+		m_selected = QFileDialog::getOpenFileName(this, tr("Load Game"), m_index.directory(), tr("Minesweeper Saves (*.sav *.ini)"));
+		if (!m_selected.isEmpty())
+		{
+			accept();
+		}
+	}
+
+}	 // namespace SPR
@@ -0,0 +1,586 @@
+#include "include/SaveFormat.h"
+
+namespace SPR
+{
+
+	const SaveFormat::Plane SaveFormat::PLANES[4] = {
+		{ &GameField::mine, 1 },
+		{ &GameField::discovered, 1 },
+		{ &GameField::disarmed, 2 },
+		{ &GameField::neighbours, 4 },
+	};
+
+	bool SaveFormat::isBinary(QIODevice *device)
+	{
+		const QByteArray magic = device->peek(sizeof(quint32));
+		if (magic.size() != sizeof(quint32))
+		{
+			return false;
+		}
+		return qFromBigEndian< quint32 >(magic.constData()) == MAGIC;
+	}
+
+	static_assert(std::is_trivially_copyable_v< GameField >, "GameField records are saved and loaded with memcpy");
+
+	ChecksumDevice::ChecksumDevice(QIODevice *target) : QIODevice(), m_target(target), m_checksum(crc32(0L, Z_NULL, 0)), m_written(0)
+	{
+		open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+	}
+
+	bool ChecksumDevice::isSequential() const
+	{
+		return true;
+	}
+
+	quint32 ChecksumDevice::checksum() const
+	{
+		return quint32(m_checksum);
+	}
+
+	qint64 ChecksumDevice::written() const
+	{
+		return m_written;
+	}
+
+	qint64 ChecksumDevice::readData(char *data, qint64 maxSize)
+	{
+		Q_UNUSED(data);
+		Q_UNUSED(maxSize);
+		return -1;
+	}
+
+	qint64 ChecksumDevice::writeData(const char *data, qint64 size)
+	{
+		const qint64 written = m_target->write(data, size);
+		if (written > 0)
+		{
+			m_checksum = crc32_z(m_checksum, reinterpret_cast< const Bytef * >(data), size_t(written));
+			m_written += written;
+		}
+		return written;
+	}
+
+	bool SaveFormat::write(QIODevice *device,
+						   const MineSweeper &board,
+						   int elapsed,
+						   bool timerRunning,
+						   Encoding encoding,
+						   qint64 journalSequence,
+						   const std::function< void(int) > &progress)
+	{
+		return writeFramed(device,
+						   headerFor(board, elapsed, timerRunning, encoding, journalSequence),
+						   [&](QIODevice *payload)
+						   {
+							   QDataStream out(payload);
+							   out.setVersion(QDataStream::Qt_5_15);
+
+							   if (encoding == Records)
+							   {
+								   out << quint32(sizeof(GameField));
+								   return out.status() == QDataStream::Ok && writeRecords(payload, board, progress);
+							   }
+
+							   const QVector< Plane > planes(std::begin(PLANES), std::end(PLANES));
+							   const QVector< QByteArray > packed = QtConcurrent::blockingMapped< QVector< QByteArray > >(
+								   planes,
+								   [&board](const Plane &plane) { return pack(board, plane); });
+
+							   for (int i = 0; i < packed.size(); ++i)
+							   {
+								   writePlane(out, packed[i]);
+								   if (progress)
+								   {
+									   progress((i + 1) * 100 / packed.size());
+								   }
+							   }
+							   return out.status() == QDataStream::Ok;
+						   });
+	}
+
+	SaveFormat::State SaveFormat::stateOf(const MineSweeper &board)
+	{
+		if (board.mineRevealed())
+		{
+			return Lost;
+		}
+		if (board.checkWinCondition())
+		{
+			return Won;
+		}
+		return board.discoveredCount() > 0 ? InProgress : NotStarted;
+	}
+
+	SaveHeader SaveFormat::headerFor(const MineSweeper &board, int elapsed, bool timerRunning, Encoding encoding, qint64 journalSequence)
+	{
+		SaveHeader header;
+		header.version = VERSION;
+		header.width = board.width();
+		header.height = board.height();
+		header.mines = board.totalMineNr();
+		header.elapsed = elapsed;
+		header.timerRunning = timerRunning;
+		header.encoding = encoding;
+		header.journalSequence = journalSequence;
+		header.state = stateOf(board);
+		header.seed = board.isGenerated() ? board.seed() : 0;
+		return header;
+	}
+
+	// The header goes in last, once the payload size and crc are known, so the device
+	// has to be seekable
+	bool SaveFormat::writeFramed(QIODevice *device, SaveHeader header, const std::function< bool(QIODevice *) > &payload)
+	{
+		const qint64 start = device->pos();
+		if (device->isSequential() || device->write(QByteArray(HEADER_SIZE, '\0')) != HEADER_SIZE)
+		{
+			return false;
+		}
+
+		ChecksumDevice sink(device);
+		if (!payload(&sink))
+		{
+			return false;
+		}
+
+		header.payloadSize = sink.written();
+		header.checksum = sink.checksum();
+		const qint64 end = device->pos();
+		const QByteArray encoded = encodeHeader(header);
+		return device->seek(start) && device->write(encoded) == encoded.size() && device->seek(end);
+	}
+
+	// magic, version, header size, dimensions, mines, elapsed, flags, state, seed, journal
+	// sequence, payload size and crc, then the crc of all that; zero padded to HEADER_SIZE
+	QByteArray SaveFormat::encodeHeader(const SaveHeader &header)
+	{
+		QByteArray bytes;
+		QDataStream out(&bytes, QIODevice::WriteOnly);
+		out.setVersion(QDataStream::Qt_5_15);
+		out << MAGIC << header.version << quint16(HEADER_SIZE);
+		out << header.width << header.height << header.mines << header.elapsed;
+		out << header.timerRunning << header.encoding << header.state << quint8(0);
+		out << header.seed << header.journalSequence << header.payloadSize << header.checksum;
+		out << quint32(crc32(0L, reinterpret_cast< const Bytef * >(bytes.constData()), uInt(bytes.size())));
+		bytes.append(QByteArray(HEADER_SIZE - bytes.size(), '\0'));
+		return bytes;
+	}
+
+	bool SaveFormat::readHeader(QIODevice *device, SaveHeader &header)
+	{
+		const QByteArray fixed = device->peek(HEADER_SIZE);
+		QDataStream in(fixed);
+		in.setVersion(QDataStream::Qt_5_15);
+
+		quint32 magic = 0;
+		quint16 headerSize = 0;
+		quint8 reserved = 0;
+		quint32 headerChecksum = 0;
+		in >> magic >> header.version >> headerSize >> header.width >> header.height >> header.mines >> header.elapsed;
+		in >> header.timerRunning >> header.encoding >> header.state >> reserved;
+		in >> header.seed >> header.journalSequence >> header.payloadSize >> header.checksum;
+		const qint64 covered = in.device()->pos();
+		in >> headerChecksum;
+		if (in.status() != QDataStream::Ok || magic != MAGIC || header.version != VERSION || headerSize < HEADER_SIZE ||
+			headerChecksum != quint32(crc32(0L, reinterpret_cast< const Bytef * >(fixed.constData()), uInt(covered))) ||
+			device->skip(headerSize) != headerSize)
+		{
+			return false;
+		}
+
+		return MineSweeper::fitsBoard(header.width, header.height) && header.mines >= 0 && header.encoding <= Moves && header.state <= Lost &&
+			   header.payloadSize >= 0;
+	}
+
+	bool SaveFormat::verify(QIODevice *device)
+	{
+		SaveHeader header;
+		if (!readHeader(device, header))
+		{
+			return false;
+		}
+
+		uLong checksum = crc32(0L, Z_NULL, 0);
+		QByteArray block(SAVE_CHUNK_BYTES, Qt::Uninitialized);
+		qint64 remaining = header.payloadSize;
+		while (remaining > 0)
+		{
+			const qint64 read = device->read(block.data(), qMin< qint64 >(block.size(), remaining));
+			if (read <= 0)
+			{
+				return false;	 // truncated
+			}
+			checksum = crc32(checksum, reinterpret_cast< const Bytef * >(block.constData()), uInt(read));
+			remaining -= read;
+		}
+		return quint32(checksum) == header.checksum;
+	}
+
+	// Flags are stored sparsely as (cell index, state); moves follow in the order played
+	bool SaveFormat::writeMoves(QIODevice *device,
+								const MineSweeper &board,
+								const MoveLog &log,
+								int elapsed,
+								bool timerRunning,
+								qint64 journalSequence)
+	{
+		const MineSweeper &start = log.start;
+		if (!start.isGenerated())
+		{
+			return false;
+		}
+
+		return writeFramed(device,
+						   headerFor(board, elapsed, timerRunning, Moves, journalSequence),
+						   [&](QIODevice *payload)
+						   {
+							   QDataStream out(payload);
+							   out.setVersion(QDataStream::Qt_5_15);
+							   out << start.seed() << qint32(start.firstClick().x()) << qint32(start.firstClick().y());
+
+							   QVector< qint64 > flagged;
+							   for (long long i = 0; i < start.size(); ++i)
+							   {
+								   if (start.cells()[i].disarmed != FIELD_NOT_VISITED)
+								   {
+									   flagged.append(i);
+								   }
+							   }
+							   out << quint32(flagged.size());
+							   for (qint64 i : flagged)
+							   {
+								   out << i << quint8(start.cells()[i].disarmed);
+							   }
+
+							   out << quint32(log.moves.size());
+							   for (const Move &move : log.moves)
+							   {
+								   out << move;
+							   }
+							   return out.status() == QDataStream::Ok;
+						   });
+	}
+
+	bool SaveFormat::readMoves(QDataStream &in, MineSweeper &board, MoveLog *log)
+	{
+		quint32 seed = 0;
+		qint32 x = -1;
+		qint32 y = -1;
+		quint32 flagCount = 0;
+		in >> seed >> x >> y >> flagCount;
+		if (in.status() != QDataStream::Ok || x < 0 || y < 0 || x >= board.width() || y >= board.height() ||
+			qint64(flagCount) * 9 > in.device()->bytesAvailable())	   // index and state
+		{
+			return false;
+		}
+
+		board.setSeed(seed);
+		board.populate(x, y);
+		for (quint32 i = 0; i < flagCount; ++i)
+		{
+			qint64 index = 0;
+			quint8 state = 0;
+			in >> index >> state;
+			if (in.status() != QDataStream::Ok || index < 0 || index >= board.size() || state > 2)
+			{
+				return false;
+			}
+			board.cells()[index].disarmed = state;
+		}
+
+		quint32 moveCount = 0;
+		in >> moveCount;
+		if (in.status() != QDataStream::Ok || qint64(moveCount) * 17 > in.device()->bytesAvailable())	// one streamed Move
+		{
+			return false;
+		}
+
+		if (log)
+		{
+			log->start = board;
+			log->moves.clear();
+			log->moves.reserve(moveCount);
+		}
+		for (quint32 i = 0; i < moveCount; ++i)
+		{
+			Move move;
+			in >> move;
+			if (in.status() != QDataStream::Ok || move.type > Move::Middle)
+			{
+				return false;
+			}
+			board.applyMove(move);
+			if (log)
+			{
+				log->moves.append(move);
+			}
+		}
+		return true;
+	}
+
+	bool SaveFormat::reproduces(const MoveLog &log, const MineSweeper &board)
+	{
+		const MineSweeper &start = log.start;
+		if (!start.isGenerated() || start.width() != board.width() || start.height() != board.height() ||
+			start.totalMineNr() != board.totalMineNr())
+		{
+			return false;
+		}
+
+		MineSweeper rebuilt;
+		rebuilt.reset(start.width(), start.height(), start.totalMineNr());
+		rebuilt.setSeed(start.seed());
+		rebuilt.populate(start.firstClick().x(), start.firstClick().y());
+		for (long long i = 0; i < start.size(); ++i)
+		{
+			rebuilt.cells()[i].disarmed = start.cells()[i].disarmed;
+		}
+		for (const Move &move : log.moves)
+		{
+			rebuilt.applyMove(move);
+		}
+
+		for (long long i = 0; i < board.size(); ++i)
+		{
+			const GameField &expected = board.cells()[i];
+			const GameField &actual = rebuilt.cells()[i];
+			if (expected.mine != actual.mine || expected.discovered != actual.discovered || expected.disarmed != actual.disarmed)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool SaveFormat::read(QIODevice *device, MineSweeper &board, SaveHeader &header, MoveLog *log)
+	{
+		if (!readHeader(device, header) || device->bytesAvailable() < header.payloadSize)
+		{
+			return false;	 // not a save, or cut short
+		}
+
+		QDataStream in(device);
+		in.setVersion(QDataStream::Qt_5_15);
+
+		board.reset(header.width, header.height, header.mines);
+		if (header.encoding == Moves)
+		{
+			return readMoves(in, board, log);
+		}
+
+		if (header.encoding == Records)
+		{
+			quint32 recordSize = 0;
+			in >> recordSize;
+			if (in.status() != QDataStream::Ok || recordSize != sizeof(GameField) || !readRecords(device, board))
+			{
+				return false;
+			}
+
+			board.restoreCounters();
+			return true;
+		}
+
+		for (const Plane &plane : PLANES)
+		{
+			QByteArray bytes;
+			if (!readPlane(in, planeBytes(board, plane), bytes) || in.status() != QDataStream::Ok || !unpack(board, plane, bytes))
+			{
+				return false;
+			}
+		}
+
+		board.restoreCounters();
+		return true;
+	}
+
+	void SaveFormat::writePlane(QDataStream &out, const QByteArray &plane)
+	{
+		QVector< qsizetype > offsets;
+		for (qsizetype offset = 0; offset < plane.size(); offset += SAVE_CHUNK_BYTES)
+		{
+			offsets.append(offset);
+		}
+
+		const QVector< QByteArray > chunks = QtConcurrent::blockingMapped< QVector< QByteArray > >(
+			offsets,
+			[&plane](qsizetype offset)
+			{
+				const qsizetype length = qMin< qsizetype >(SAVE_CHUNK_BYTES, plane.size() - offset);
+				return qCompress(reinterpret_cast< const uchar * >(plane.constData() + offset), length, SAVE_COMPRESSION);
+			});
+
+		out << qint64(plane.size()) << quint32(chunks.size());
+		for (int i = 0; i < chunks.size(); ++i)
+		{
+			out << quint32(qMin< qsizetype >(SAVE_CHUNK_BYTES, plane.size() - offsets[i])) << quint32(chunks[i].size());
+		}
+		for (const QByteArray &chunk : chunks)
+		{
+			out.writeRawData(chunk.constData(), chunk.size());
+		}
+	}
+
+	bool SaveFormat::readPlane(QDataStream &in, qint64 expectedSize, QByteArray &plane)
+	{
+		qint64 size = 0;
+		quint32 count = 0;
+		in >> size >> count;
+		if (in.status() != QDataStream::Ok || size != expectedSize || qint64(count) != (size + SAVE_CHUNK_BYTES - 1) / SAVE_CHUNK_BYTES)
+		{
+			return false;
+		}
+
+		QVector< quint32 > rawSizes(count);
+		QVector< qint64 > offsets(count);
+		QVector< quint32 > compressedSizes(count);
+		qint64 total = 0;
+		for (quint32 i = 0; i < count; ++i)
+		{
+			in >> rawSizes[i] >> compressedSizes[i];
+			if (rawSizes[i] > quint32(SAVE_CHUNK_BYTES) || compressedSizes[i] < sizeof(quint32))
+			{
+				return false;
+			}
+			offsets[i] = total;
+			total += compressedSizes[i];
+		}
+
+		if (in.status() != QDataStream::Ok || total > in.device()->bytesAvailable())
+		{
+			return false;	 // the table promises more than the file holds
+		}
+
+		QByteArray compressed(total, Qt::Uninitialized);
+		if (in.readRawData(compressed.data(), total) != total)
+		{
+			return false;
+		}
+
+		QVector< int > indices(count);
+		std::iota(indices.begin(), indices.end(), 0);
+		const QVector< QByteArray > chunks = QtConcurrent::blockingMapped< QVector< QByteArray > >(
+			indices,
+			[&](int i)
+			{
+				// qUncompress allocates whatever length the chunk's own prefix names
+				const uchar *chunk = reinterpret_cast< const uchar * >(compressed.constData() + offsets[i]);
+				if (qFromBigEndian< quint32 >(chunk) != rawSizes[i])
+				{
+					return QByteArray();
+				}
+				return qUncompress(chunk, compressedSizes[i]);
+			});
+
+		plane.resize(size);
+		qsizetype written = 0;
+		for (quint32 i = 0; i < count; ++i)
+		{
+			if (chunks[i].size() != qsizetype(rawSizes[i]) || written + chunks[i].size() > size)
+			{
+				return false;
+			}
+			memcpy(plane.data() + written, chunks[i].constData(), chunks[i].size());
+			written += chunks[i].size();
+		}
+		return written == size;
+	}
+
+	bool SaveFormat::writeRecords(QIODevice *device, const MineSweeper &board, const std::function< void(int) > &progress)
+	{
+		const qint64 bytes = board.size() * qint64(sizeof(GameField));
+		const char *data = reinterpret_cast< const char * >(board.cells());
+		const qint64 step = qint64(SAVE_CHUNK_BYTES) * 64;
+
+		for (qint64 offset = 0; offset < bytes; offset += step)
+		{
+			const qint64 length = qMin(step, bytes - offset);
+			if (device->write(data + offset, length) != length)
+			{
+				return false;
+			}
+			if (progress)
+			{
+				progress(int((offset + length) * 100 / bytes));
+			}
+		}
+		return true;
+	}
+
+	// Files are mapped and copied in one go; other devices are read straight into the board
+	bool SaveFormat::readRecords(QIODevice *device, MineSweeper &board)
+	{
+		const qint64 bytes = board.size() * qint64(sizeof(GameField));
+		if (device->bytesAvailable() < bytes)
+		{
+			return false;
+		}
+
+		bool copied = false;
+		QFileDevice *file = qobject_cast< QFileDevice * >(device);
+		if (uchar *mapped = file ? file->map(file->pos(), bytes) : nullptr)
+		{
+			memcpy(board.cells(), mapped, bytes);
+			file->unmap(mapped);
+			copied = file->seek(file->pos() + bytes);
+		}
+		else
+		{
+			copied = device->read(reinterpret_cast< char * >(board.cells()), bytes) == bytes;
+		}
+		if (!copied)
+		{
+			return false;
+		}
+
+		// The records carry the highlight and debug bytes of the board that was saved
+		GameField *cells = board.cells();
+		for (long long i = 0; i < board.size(); ++i)
+		{
+			if (!sanitizeRaw(cells[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	qint64 SaveFormat::planeBytes(const MineSweeper &board, const Plane &plane)
+	{
+		const int perByte = 8 / plane.bits;
+		return (board.size() + perByte - 1) / perByte;
+	}
+
+	QByteArray SaveFormat::pack(const MineSweeper &board, const Plane &plane)
+	{
+		const int perByte = 8 / plane.bits;
+		const int mask = (1 << plane.bits) - 1;
+
+		QByteArray bytes(planeBytes(board, plane), '\0');
+		uchar *out = reinterpret_cast< uchar * >(bytes.data());
+		for (long long i = 0; i < board.size(); ++i)
+		{
+			const int value = board.fieldConst(i % board.width(), i / board.width()).*plane.member & mask;
+			out[i / perByte] |= value << (i % perByte * plane.bits);
+		}
+		return bytes;
+	}
+
+	bool SaveFormat::unpack(MineSweeper &board, const Plane &plane, const QByteArray &bytes)
+	{
+		const int perByte = 8 / plane.bits;
+		const int mask = (1 << plane.bits) - 1;
+		if (bytes.size() != planeBytes(board, plane))
+		{
+			return false;
+		}
+
+		const uchar *in = reinterpret_cast< const uchar * >(bytes.constData());
+		for (long long i = 0; i < board.size(); ++i)
+		{
+			board.field(i % board.width(), i / board.width()).*plane.member = (in[i / perByte] >> (i % perByte * plane.bits)) & mask;
+		}
+		return true;
+	}
+
+}	 // namespace SPR
@@ -0,0 +1,213 @@
+#include "include/SaveIndex.h"
+
+namespace SPR
+{
+
+	SaveIndex::SaveIndex(const QString &directory, QObject *parent) :
+		QObject(parent), m_directory(directory), m_mutex(), m_entries(), m_queued(0), m_watcher(), m_worker()
+	{
+		m_worker.setMaxThreadCount(1);
+		readIndex(indexPath(), m_entries);
+
+		if (QDir(m_directory).exists())
+		{
+			m_watcher.addPath(m_directory);
+		}
+		connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &SaveIndex::refresh);
+	}
+
+	SaveIndex::~SaveIndex()
+	{
+		waitForRefresh();
+	}
+
+	QString SaveIndex::directory() const
+	{
+		return m_directory;
+	}
+
+	QString SaveIndex::indexPath() const
+	{
+		return QDir(m_directory).filePath(FileFormat::INDEX_FILE);
+	}
+
+	QVector< SaveIndex::Entry > SaveIndex::entries() const
+	{
+		QMutexLocker locker(&m_mutex);
+		return m_entries;
+	}
+
+	// Writing the index changes the directory too; the scan that follows finds nothing to do
+	void SaveIndex::refresh()
+	{
+		if (m_queued.testAndSetOrdered(0, 1))
+		{
+			QtConcurrent::run(&m_worker, [this]() { scan(); });
+		}
+	}
+
+	void SaveIndex::waitForRefresh()
+	{
+		m_worker.waitForDone();
+	}
+
+	void SaveIndex::scan()
+	{
+		m_queued.storeRelease(0);	 // changes from here on need another scan
+
+		QHash< QString, Entry > known;
+		for (const Entry &entry : entries())
+		{
+			known.insert(entry.fileName, entry);
+		}
+
+		const QFileInfoList files =
+			QDir(m_directory).entryInfoList({ "*.sav", "*.ini" }, QDir::Files | QDir::Readable, QDir::Name);
+
+		QVector< Entry > scanned;
+		bool changed = files.size() != known.size();
+		for (const QFileInfo &info : files)
+		{
+			const auto cached = known.constFind(info.fileName());
+			if (cached != known.constEnd() && cached->modified == info.lastModified().toMSecsSinceEpoch() && cached->size == info.size())
+			{
+				scanned.append(*cached);
+				continue;
+			}
+
+			changed = true;
+			Entry entry;
+			entry.fileName = info.fileName();
+			entry.modified = info.lastModified().toMSecsSinceEpoch();
+			entry.size = info.size();
+			entry.readable = readEntry(info, entry);
+			scanned.append(entry);
+		}
+
+		if (!changed)
+		{
+			return;
+		}
+
+		{
+			QMutexLocker locker(&m_mutex);
+			m_entries = scanned;
+		}
+		writeIndex(indexPath(), scanned);
+		emit updated();
+	}
+
+	// The only place a save is parsed: once, when it is new or has changed
+	bool SaveIndex::readEntry(const QFileInfo &info, Entry &entry)
+	{
+		QFile file(info.filePath());
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		MineSweeper board;
+		SaveHeader header;
+		const bool ok = SaveFormat::isBinary(&file) ? SaveFormat::read(&file, board, header)
+													: LegacyIniReader::read(&file, board, header, false);
+		if (!ok)
+		{
+			return false;
+		}
+
+		header.state = SaveFormat::stateOf(board);
+		entry.header = header;
+		entry.thumbnail = thumbnail(board, header.state == SaveFormat::Won || header.state == SaveFormat::Lost);
+		return true;
+	}
+
+	QImage SaveIndex::thumbnail(const MineSweeper &board, bool gameOver)
+	{
+		if (board.size() <= 0)
+		{
+			return QImage();
+		}
+
+		// One pixel per cell: below LOD_CELL_SIZE the renderer needs no sprite atlas, so
+		// this is safe off the GUI thread
+		const BoardRenderer renderer(board, gameOver, false, 1);
+		const QSize cells = renderer.imageSize();
+		const QSize size = cells.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio).boundedTo(cells).expandedTo(QSize(1, 1));
+
+		QImage image(size, QImage::Format_RGB32);
+		for (int y = 0; y < size.height(); ++y)
+		{
+			const int row = int(qint64(y) * renderer.rowCount() / size.height());
+			QRgb *line = reinterpret_cast< QRgb * >(image.scanLine(y));
+			for (int x = 0; x < size.width(); ++x)
+			{
+				line[x] = flatColor(renderer.spriteAt(row, int(qint64(x) * renderer.columnCount() / size.width())));
+			}
+		}
+		return image;
+	}
+
+	bool SaveIndex::readIndex(const QString &filepath, QVector< Entry > &entries)
+	{
+		QFile file(filepath);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		QDataStream in(&file);
+		in.setVersion(QDataStream::Qt_5_15);
+		quint32 magic = 0;
+		quint16 version = 0;
+		qint32 count = 0;
+		in >> magic >> version >> count;
+		if (magic != MAGIC || version != VERSION || count < 0)
+		{
+			return false;
+		}
+
+		QVector< Entry > read;
+		for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+		{
+			Entry entry;
+			SaveHeader &header = entry.header;
+			in >> entry.fileName >> entry.modified >> entry.size >> entry.readable >> header.version >> header.width >> header.height >> header.mines
+				>> header.elapsed >> header.timerRunning >> header.state >> header.seed >> entry.thumbnail;
+			read.append(entry);
+		}
+
+		if (in.status() != QDataStream::Ok)
+		{
+			return false;
+		}
+		entries = read;
+		return true;
+	}
+
+	bool SaveIndex::writeIndex(const QString &filepath, const QVector< Entry > &entries)
+	{
+		QSaveFile file(filepath);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return false;
+		}
+
+		QDataStream out(&file);
+		out.setVersion(QDataStream::Qt_5_15);
+		out << MAGIC << VERSION << qint32(entries.size());
+		for (const Entry &entry : entries)
+		{
+			const SaveHeader &header = entry.header;
+			out << entry.fileName << entry.modified << entry.size << entry.readable << header.version << header.width << header.height << header.mines
+				<< header.elapsed << header.timerRunning << header.state << header.seed << entry.thumbnail;
+		}
+
+		if (out.status() != QDataStream::Ok)
+		{
+			file.cancelWriting();
+			return false;
+		}
+		return file.commit();
+	}
+
+}	 // namespace SPR
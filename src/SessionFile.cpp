@@ -0,0 +1,301 @@
+#include "include/SessionFile.h"
+
+// Only the flush needs the platform's mapping calls; they stay out of the header
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace SPR
+{
+
+	SessionFile::SessionFile(const QString &filepath, QObject *parent) :
+		QObject(parent), m_file(filepath), m_data(nullptr), m_size(0), m_dirty(), m_allDirty(true), m_syncedFirstClick(-1, -1),
+		m_flushTimer(), m_flusher()
+	{
+		m_flusher.setMaxThreadCount(1);
+		m_flushTimer.setSingleShot(true);
+		m_flushTimer.setInterval(SESSION_FLUSH_MS);
+		connect(&m_flushTimer, &QTimer::timeout, this, &SessionFile::flush);
+	}
+
+	SessionFile::~SessionFile()
+	{
+		close();
+	}
+
+	QString SessionFile::path() const
+	{
+		return m_file.fileName();
+	}
+
+	bool SessionFile::isOpen() const
+	{
+		return m_data != nullptr;
+	}
+
+	void SessionFile::markChanged(const QRect &cells)
+	{
+		m_dirty |= cells;
+	}
+
+	void SessionFile::markAllChanged()
+	{
+		m_allDirty = true;
+	}
+
+	bool SessionFile::sync(const MineSweeper &board, int elapsed, bool timerRunning, qint64 journalSequence)
+	{
+		const qint64 size = qint64(sizeof(Header)) + board.size() * qint64(sizeof(GameField));
+		if (!m_data || m_size != size)
+		{
+			if (!open(board))
+			{
+				return false;
+			}
+			m_allDirty = true;
+		}
+
+		Header *header = reinterpret_cast< Header * >(m_data);
+		GameField *cells = reinterpret_cast< GameField * >(m_data + sizeof(Header));
+		// A new seed or first click means a new layout: the mines are nowhere in m_dirty
+		if (m_allDirty || header->width != board.width() || header->seed != board.seed() || m_syncedFirstClick != board.firstClick())
+		{
+			memcpy(cells, board.cells(), board.size() * sizeof(GameField));
+		}
+		else
+		{
+			const QRect dirty = m_dirty & QRect(0, 0, board.width(), board.height());
+			for (int y = dirty.top(); y <= dirty.bottom(); ++y)
+			{
+				const qint64 first = qint64(y) * board.width() + dirty.left();
+				memcpy(cells + first, board.cells() + first, dirty.width() * sizeof(GameField));
+			}
+		}
+		m_dirty = QRect();
+		m_allDirty = false;
+		m_syncedFirstClick = board.firstClick();
+
+		header->width = board.width();
+		header->height = board.height();
+		header->mines = board.totalMineNr();
+		header->seed = board.seed();
+		header->elapsed = elapsed;
+		header->timerRunning = timerRunning;
+		header->state = SaveFormat::stateOf(board);
+		header->journalSequence = journalSequence;
+		header->version = VERSION;
+		header->cellSize = sizeof(GameField);
+		header->magic = MAGIC;	  // last: a file without it is never loaded
+
+		scheduleFlush();
+		return true;
+	}
+
+	void SessionFile::syncTime(int elapsed, bool timerRunning)
+	{
+		if (!m_data)
+		{
+			return;
+		}
+
+		Header *header = reinterpret_cast< Header * >(m_data);
+		header->elapsed = elapsed;
+		header->timerRunning = timerRunning;
+		scheduleFlush();
+	}
+
+	// The pages are written on the worker; the mapping stays until close() has waited for it
+	void SessionFile::flush()
+	{
+		m_flushTimer.stop();
+		if (!m_data)
+		{
+			return;
+		}
+
+		uchar *data = m_data;
+		const qint64 size = m_size;
+		QtConcurrent::run(&m_flusher, [data, size]() { flushRange(data, size); });
+	}
+
+	// Queued even with nothing mapped, so a failure is reported in order too
+	void SessionFile::flushDurably()
+	{
+		m_flushTimer.stop();
+		uchar *data = m_data;
+		const qint64 size = m_size;
+		QtConcurrent::run(&m_flusher,
+						  [this, data, size]()
+						  {
+							  const bool ok = data && flushRange(data, size);
+							  QMetaObject::invokeMethod(this, [this, ok]() { emit flushed(ok); }, Qt::QueuedConnection);
+						  });
+	}
+
+	void SessionFile::close()
+	{
+		m_flushTimer.stop();
+		m_flusher.waitForDone();
+		if (m_data)
+		{
+			m_file.unmap(m_data);
+		}
+		m_file.close();
+		m_data = nullptr;
+		m_size = 0;
+		m_allDirty = true;
+	}
+
+	void SessionFile::discard()
+	{
+		close();
+		QFile::remove(path());
+	}
+
+	bool SessionFile::readHeader(const QString &filepath, SaveHeader &header)
+	{
+		QFile file(filepath);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		const QByteArray bytes = file.read(sizeof(Header));
+		const Header *stored = validHeader(reinterpret_cast< const uchar * >(bytes.constData()), bytes.size());
+		if (!stored)
+		{
+			return false;
+		}
+
+		const qint64 cells = qint64(stored->width) * stored->height;
+		if (file.size() != qint64(sizeof(Header)) + cells * qint64(sizeof(GameField)))
+		{
+			return false;
+		}
+		header = toSaveHeader(*stored);
+		return true;
+	}
+
+	bool SessionFile::load(const QString &filepath, MineSweeper &board, SaveHeader &header)
+	{
+		QFile file(filepath);
+		if (!file.open(QIODevice::ReadOnly) || !readHeader(filepath, header))
+		{
+			return false;
+		}
+
+		const qint64 bytes = qint64(header.width) * header.height * qint64(sizeof(GameField));
+		uchar *mapped = file.map(sizeof(Header), bytes);
+		if (!mapped)
+		{
+			return false;
+		}
+
+		MineSweeper loaded;
+		loaded.reset(header.width, header.height, header.mines);
+		loaded.setSeed(header.seed);
+		memcpy(loaded.cells(), mapped, bytes);
+		file.unmap(mapped);
+
+		GameField *cells = loaded.cells();
+		for (long long i = 0; i < loaded.size(); ++i)
+		{
+			if (!sanitizeRaw(cells[i]))
+			{
+				return false;	 // damaged; nothing checks these bytes otherwise
+			}
+		}
+		loaded.restoreCounters();
+
+		board = std::move(loaded);
+		return true;
+	}
+
+	// Reuses the file when it already has the right size; its old header stays valid until
+	// the first sync replaces it
+	bool SessionFile::open(const MineSweeper &board)
+	{
+		close();
+
+		const qint64 size = qint64(sizeof(Header)) + board.size() * qint64(sizeof(GameField));
+		const bool resized = !m_file.exists() || m_file.size() != size;
+		if (!m_file.open(QIODevice::ReadWrite) || (resized && !m_file.resize(size)))
+		{
+			m_file.close();
+			return false;
+		}
+
+		m_data = m_file.map(0, size);
+		if (!m_data)
+		{
+			m_file.close();
+			return false;
+		}
+		m_size = size;
+
+		if (resized)
+		{
+			// Not loadable until the first sync has written the cells
+			Header *header = reinterpret_cast< Header * >(m_data);
+			memset(header, 0, sizeof(Header));
+			header->version = VERSION;
+			header->cellSize = sizeof(GameField);
+		}
+		return true;
+	}
+
+	void SessionFile::scheduleFlush()
+	{
+		if (!m_flushTimer.isActive())
+		{
+			m_flushTimer.start();
+		}
+	}
+
+	bool SessionFile::flushRange(uchar *data, qint64 size)
+	{
+#ifdef Q_OS_WIN
+		return FlushViewOfFile(data, SIZE_T(size)) != 0;
+#else
+		return msync(data, size_t(size), MS_SYNC) == 0;
+#endif
+	}
+
+	const SessionFile::Header *SessionFile::validHeader(const uchar *data, qint64 size)
+	{
+		if (size < qint64(sizeof(Header)))
+		{
+			return nullptr;
+		}
+
+		const Header *header = reinterpret_cast< const Header * >(data);
+		if (header->magic != MAGIC || header->version != VERSION || header->cellSize != sizeof(GameField) || header->width <= 0
+			|| header->height <= 0 || header->width > std::numeric_limits< int >::max() / header->height)
+		{
+			return nullptr;
+		}
+		return header;
+	}
+
+	SaveHeader SessionFile::toSaveHeader(const Header &header)
+	{
+		SaveHeader converted;
+		converted.version = header.version;
+		converted.width = header.width;
+		converted.height = header.height;
+		converted.mines = header.mines;
+		converted.elapsed = header.elapsed;
+		converted.timerRunning = header.timerRunning != 0;
+		converted.encoding = SaveFormat::Records;
+		converted.journalSequence = header.journalSequence;
+		converted.state = header.state;
+		converted.seed = header.seed;
+		return converted;
+	}
+
+}	 // namespace SPR
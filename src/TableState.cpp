@@ -8,15 +8,7 @@ namespace SPR
 	{
 		m_highlightClearTimer = new QTimer(this);
 		m_highlightClearTimer->setSingleShot(true);
-		connect(
-			m_highlightClearTimer,
-			&QTimer::timeout,
-			this,
-			[this]()
-			{
-				_model.clearHighlights();
-				emit layoutChanged();
-			});
+		connect(m_highlightClearTimer, &QTimer::timeout, this, &TableState::clearHighlight);
 	}
 
 	void TableState::init(const QModelIndex &index)
@@ -36,6 +28,105 @@ namespace SPR
 		}
 	}
 
+	bool TableState::isDebugMode() const
+	{
+		return _debugMode;
+	}
+
+	void TableState::setLatencyTracker(LatencyTracker *latency)
+	{
+		m_latency = latency;
+	}
+
+	void TableState::setFrameBudget(int msec)
+	{
+		m_frameBudget = msec;
+	}
+
+	void TableState::markLatency(LatencyTracker::Stage stage)
+	{
+		if (m_latency)
+		{
+			m_latency->mark(stage);
+		}
+	}
+
+	void TableState::beginBatch()
+	{
+		++m_batchDepth;
+	}
+
+	void TableState::endBatch()
+	{
+		Q_ASSERT(m_batchDepth > 0);
+		if (--m_batchDepth == 0 && !m_batchChanged.isEmpty())
+		{
+			const QVector< QRect > changed = std::exchange(m_batchChanged, QVector< QRect >());
+			for (const QRect &region : changed)
+			{
+				notifyChanged(region);
+			}
+		}
+	}
+
+	// Nearby changes share a rect, distant ones keep their own, so two far-apart clicks in
+	// one batch do not mark everything between them as changed
+	void TableState::addBatchChange(const QRect &changed)
+	{
+		auto area = [](const QRect &rect) { return qint64(rect.width()) * rect.height(); };
+		auto growth = [&area](const QRect &a, const QRect &b) { return area(a | b) - area(a) - area(b); };
+
+		QRect merged = changed;
+		for (int i = 0; i < m_batchChanged.size(); ++i)
+		{
+			if (growth(m_batchChanged[i], merged) <= BATCH_MERGE_SLACK)
+			{
+				merged |= m_batchChanged.takeAt(i);
+				i = -1;	   // the grown rect may now reach regions already passed
+			}
+		}
+
+		if (m_batchChanged.size() >= BATCH_REGIONS)
+		{
+			int cheapest = 0;
+			for (int i = 1; i < m_batchChanged.size(); ++i)
+			{
+				if (growth(m_batchChanged[i], merged) < growth(m_batchChanged[cheapest], merged))
+				{
+					cheapest = i;
+				}
+			}
+			merged |= m_batchChanged.takeAt(cheapest);
+		}
+		m_batchChanged.append(merged);
+	}
+
+	// changed holds board cells, x is the row and y the column
+	void TableState::notifyChanged(const QRect &changed)
+	{
+		if (changed.isNull())
+		{
+			return;
+		}
+
+		if (m_batchDepth > 0)
+		{
+			addBatchChange(changed);
+			return;
+		}
+
+		markLatency(LatencyTracker::DataChanged);
+		emit dataChanged(index(changed.left(), changed.top()), index(changed.right(), changed.bottom()));
+	}
+
+	// Every highlighted cell is repainted, also when a new highlight replaces this one
+	void TableState::clearHighlight()
+	{
+		_model.clearHighlights();
+		notifyChanged(m_highlighted);
+		m_highlighted = QRect();
+	}
+
 	int TableState::rowCount(const QModelIndex &parent) const
 	{
 		Q_UNUSED(parent);
@@ -48,27 +139,22 @@ namespace SPR
 		return _model.height();
 	}
 
+	// Only Qt::UserRole carries the cell; views that paint should use cell() instead
 	QVariant TableState::data(const QModelIndex &index, int role) const
 	{
-		GameField field = _model.fieldConst(index.row(), index.column());
-
-		QVariant variant;
-		variant.setValue(field);
-
-		// Debug mode handling
-		if (_debugMode)
+		if (role != Qt::UserRole || !index.isValid())
 		{
-			GameField fieldCopy = field;
-			fieldCopy.isDebug = true;
-			variant.setValue(fieldCopy);
+			return QVariant();
 		}
 
-		if (field.isHighlighted)
-		{
-			field.isDebug = true;
-		}
+		GameField field = cell(index.row(), index.column());
+		field.isDebug = _debugMode;
+		return QVariant::fromValue(field);
+	}
 
-		return variant;
+	const GameField &TableState::cell(int row, int column) const
+	{
+		return _model.fieldConst(row, column);
 	}
 
 	bool TableState::hasLost() const
@@ -98,13 +184,37 @@ namespace SPR
 	{
 		m_initialized = false;
 		m_mineDisplay = mine;
+		m_highlightClearTimer->stop();
+		m_highlighted = QRect();	// cells of the old board
 		_model.reset(width, height, mine);
 		emit mineDisplay(mine);
 		emit layoutChanged();
 	}
 
+	void TableState::resumeLoaded()
+	{
+		bool populated = false;
+		int flags = 0;
+		const long long count = _model.size();
+		const GameField *cells = _model.cells();
+		for (long long i = 0; i < count; ++i)
+		{
+			populated = populated || cells[i].mine || cells[i].discovered;
+			if (cells[i].disarmed == FIELD_VISITED)
+			{
+				++flags;
+			}
+		}
+
+		m_initialized = populated;
+		m_mineDisplay = _model.totalMineNr() - flags;
+		emit mineDisplay(m_mineDisplay);
+		emit layoutChanged();
+	}
+
 	void TableState::onTableClicked(const QModelIndex &index)
 	{
+		markLatency(LatencyTracker::Slot);
 		if (_model.field(index.row(), index.column()).disarmed == 0)
 		{
 			discover(index);
@@ -118,50 +228,46 @@ namespace SPR
 			init(index);
 		}
 
-		const int x = index.row();
-		const int y = index.column();
+		_model.queueReveal(index.row(), index.column());
+		processReveal();
+	}
 
-		_model.discover(x, y);
+	// Reveals queued cells until the frame budget runs out, then yields to the event loop.
+	// Win and loss are only reported once the queue has drained.
+	void TableState::processReveal()
+	{
+		QElapsedTimer budget;
+		budget.start();
 
-		if (_model.field(x, y).neighbours == 0 && _model.field(x, y).mine == 0)
+		QRect changed;
+		do
 		{
-			if (!_model.getDiscovered(x - 1, y - 1))
-			{	 // up
-				discover(index.sibling(x - 1, y - 1));
-			}
-			if (!_model.getDiscovered(x, y - 1))
-			{
-				discover(index.sibling(x, y - 1));
-			}
-			if (!_model.getDiscovered(x + 1, y - 1))
-			{
-				discover(index.sibling(x + 1, y - 1));
-			}
-			if (!_model.getDiscovered(x - 1, y))
-			{
-				discover(index.sibling(x - 1, y));
-			}	 // mid
-			if (!_model.getDiscovered(x + 1, y))
-			{
-				discover(index.sibling(x + 1, y));
-			}
-			if (!_model.getDiscovered(x - 1, y + 1))
-			{
-				discover(index.sibling(x - 1, y + 1));
-			}	 // down
-			if (!_model.getDiscovered(x, y + 1))
-			{
-				discover(index.sibling(x, y + 1));
-			}
-			if (!_model.getDiscovered(x + 1, y + 1))
+			_model.revealPending(REVEAL_BATCH, changed);
+		} while (_model.hasPendingReveal() && budget.elapsed() < m_frameBudget);
+		markLatency(LatencyTracker::Engine);
+
+		notifyChanged(changed);
+
+		if (_model.hasPendingReveal())
+		{
+			if (!m_revealScheduled)
 			{
-				discover(index.sibling(x + 1, y + 1));
+				m_revealScheduled = true;
+				QTimer::singleShot(0,
+								   this,
+								   [this]()
+								   {
+									   m_revealScheduled = false;
+									   if (_model.hasPendingReveal())
+									   {
+										   processReveal();
+									   }
+								   });
 			}
+			return;
 		}
 
-		emit dataChanged(index, index);
-
-		if (_model.field(x, y).mine && _model.field(x, y).disarmed == 0)
+		if (_model.mineRevealed())
 		{
 			emit gameLost();
 		}
@@ -173,12 +279,14 @@ namespace SPR
 
 	void TableState::onRightClicked(const QModelIndex &index)
 	{
+		markLatency(LatencyTracker::Slot);
 		const int x = index.row();
 		const int y = index.column();
 
 		if (_model.field(x, y).discovered == FIELD_NOT_VISITED)
 		{
 			_model.disarm(x, y);
+			markLatency(LatencyTracker::Engine);
 
 			if (_model.field(x, y).disarmed == FIELD_VISITED)
 			{
@@ -190,54 +298,22 @@ namespace SPR
 			}
 
 			emit mineDisplay(m_mineDisplay);
-			emit dataChanged(index, index);
+			notifyChanged(QRect(x, y, 1, 1));
 		}
 	}
 
 	void TableState::onBothClicked(const QModelIndex &index)
 	{
-		const int x = index.row();
-		const int y = index.column();
-
-		if (_model.getDiscovered(x, y) && _model.getNeighbours(x, y) == _model.countFlagsAround(x, y))
+		markLatency(LatencyTracker::Slot);
+		if (_model.queueChord(index.row(), index.column()))
 		{
-			if (!_model.getDiscovered(x - 1, y - 1))
-			{
-				discover(index.sibling(x - 1, y - 1));	  // up
-			}
-			if (!_model.getDiscovered(x, y - 1))
-			{
-				discover(index.sibling(x, y - 1));
-			}
-			if (!_model.getDiscovered(x + 1, y - 1))
-			{
-				discover(index.sibling(x + 1, y - 1));
-			}
-			if (!_model.getDiscovered(x - 1, y))
-			{
-				discover(index.sibling(x - 1, y));	  // mid
-			}
-			if (!_model.getDiscovered(x + 1, y))
-			{
-				discover(index.sibling(x + 1, y));
-			}
-			if (!_model.getDiscovered(x - 1, y + 1))
-			{
-				discover(index.sibling(x - 1, y + 1));	  // down
-			}
-			if (!_model.getDiscovered(x, y + 1))
-			{
-				discover(index.sibling(x, y + 1));
-			}
-			if (!_model.getDiscovered(x + 1, y + 1))
-			{
-				discover(index.sibling(x + 1, y + 1));
-			}
+			processReveal();
 		}
 	}
 
 	void TableState::onMiddleClicked(const QModelIndex &index)
 	{
+		markLatency(LatencyTracker::Slot);
 		const int x = index.row();
 		const int y = index.column();
 
@@ -246,7 +322,7 @@ namespace SPR
 			return;
 		}
 
-		_model.clearHighlights();
+		clearHighlight();
 
 		if (_model.getNeighbours(x, y) != _model.countFlagsAround(x, y))
 		{
@@ -276,7 +352,9 @@ namespace SPR
 				}
 			}
 
-			emit dataChanged(index.sibling(minX, minY), index.sibling(maxX, maxY));
+			m_highlighted = QRect(QPoint(minX, minY), QPoint(maxX, maxY));
+			markLatency(LatencyTracker::Engine);
+			notifyChanged(m_highlighted);
 			m_highlightClearTimer->start(HIGHLIGHT_TIMEOUT);
 		}
 		else
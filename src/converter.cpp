@@ -0,0 +1,125 @@
+#include "include/Constants.h"
+#include "include/LegacyIniReader.h"
+#include "include/SaveFormat.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+// Converts legacy INI saves to the binary format, one file or a whole directory at a time
+struct Conversion
+{
+	QString source;
+	QString target;
+	QString error;	  // empty on success
+};
+
+static Conversion convert(const QString &source, const QDir &outputDir, bool validate)
+{
+	Conversion result;
+	result.source = source;
+	result.target = outputDir.filePath(QFileInfo(source).completeBaseName() + ".sav");
+
+	QFile input(source);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		result.error = input.errorString();
+		return result;
+	}
+
+	SPR::MineSweeper board;
+	SPR::SaveHeader header;
+	if (!SPR::LegacyIniReader::read(&input, board, header, validate, &result.error))
+	{
+		return result;
+	}
+
+	QSaveFile output(result.target);
+	const SPR::SaveFormat::Encoding encoding = board.size() >= SPR::SAVE_RAW_CELLS ? SPR::SaveFormat::Records : SPR::SaveFormat::Planes;
+	if (!output.open(QIODevice::WriteOnly) || !SPR::SaveFormat::write(&output, board, header.elapsed, header.timerRunning, encoding) ||
+		!output.commit())
+	{
+		result.error = output.errorString().isEmpty() ? QString("could not write %1").arg(result.target) : output.errorString();
+	}
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("minesweeper-convert");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Converts legacy INI saves (a Cell_x_y group per cell) to binary .sav files.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("input", "An INI save, or a directory of them.");
+	QCommandLineOption outputOption({ "o", "output" }, "Directory for the .sav files (default: next to each input).", "dir");
+	QCommandLineOption noValidateOption("no-validate", "Do not check neighbour counts against the mines.");
+	QCommandLineOption jobsOption({ "j", "jobs" }, "Files converted at once (default: one per core).", "n");
+	parser.addOption(outputOption);
+	parser.addOption(noValidateOption);
+	parser.addOption(jobsOption);
+	parser.process(app);
+
+	if (parser.positionalArguments().size() != 1)
+	{
+		parser.showHelp(1);
+	}
+
+	const QFileInfo input(parser.positionalArguments().first());
+	QStringList sources;
+	if (input.isDir())
+	{
+		const QDir dir(input.filePath());
+		for (const QString &name : dir.entryList({ "*.ini" }, QDir::Files, QDir::Name))
+		{
+			sources.append(dir.filePath(name));
+		}
+	}
+	else
+	{
+		sources.append(input.filePath());
+	}
+
+	const QDir outputDir(parser.isSet(outputOption) ? parser.value(outputOption) : (input.isDir() ? input.filePath() : input.path()));
+	if (!outputDir.exists() && !QDir().mkpath(outputDir.path()))
+	{
+		QTextStream(stderr) << "cannot create " << outputDir.path() << Qt::endl;
+		return 1;
+	}
+
+	// Files get their own pool; the global one stays free for compressing their planes
+	QThreadPool files;
+	if (parser.isSet(jobsOption))
+	{
+		files.setMaxThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+	}
+
+	const bool validate = !parser.isSet(noValidateOption);
+	const QList< Conversion > results = QtConcurrent::blockingMapped< QList< Conversion > >(
+		&files,
+		sources,
+		[&outputDir, validate](const QString &source) { return convert(source, outputDir, validate); });
+
+	QTextStream out(stdout);
+	int failed = 0;
+	for (const Conversion &result : results)
+	{
+		if (result.error.isEmpty())
+		{
+			out << "ok     " << result.source << " -> " << result.target << Qt::endl;
+		}
+		else
+		{
+			out << "failed " << result.source << ": " << result.error << Qt::endl;
+			++failed;
+		}
+	}
+	out << results.size() - failed << " converted, " << failed << " failed" << Qt::endl;
+	return failed == 0 ? 0 : 1;
+}
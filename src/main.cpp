@@ -23,5 +23,8 @@ int main(int argc, char *argv[])
 	SPR::MainWindow window(debugMode);
 	window.show();
 	window.updateView();
-	return a.exec();
+
+	const int result = a.exec();
+	window.waitForSaves();	  // the autosave from closeEvent may still be writing
+	return result;
 }
@@ -4,8 +4,9 @@ namespace SPR
 {
 
 	MainWindow::MainWindow(bool debugMode, QWidget *parent) :
-		QMainWindow(parent), _topWidget(nullptr), _view(nullptr), _model(), _timer(), _prefs(),
-		_saveSystem(_model.getMineSweeper(), _timer, _prefs, this), _debugMode(debugMode)
+		QMainWindow(parent), _topWidget(nullptr), _view(nullptr), _miniMap(nullptr), _model(), _timer(), _frameStats(), _latency(), _recorder(), _prefs(),
+		_saveSystem(_model.getMineSweeper(), _timer, _prefs, this), _journal(Save::journalPath()), _debugMode(debugMode), _debugForced(debugMode),
+		_compactSaves(false), _sessionSyncQueued(false)
 	{
 		QSettings settings;
 		QString language = settings.value("language", "en_US").toString();
@@ -37,45 +38,63 @@ namespace SPR
 		_topWidget->setMaximumSize(MAX_WIDTH, MAX_HEIGHT);
 
 		// Table view
-		_view = new TableView(centralWidget);
+		_view = new BoardView(centralWidget);
 		_view->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 		_view->setStyleSheet("background-color: rgb(222, 222, 222)");
 
+		// Minimap, shown only when the board does not fit
+		_miniMap = new MiniMap(centralWidget);
+		_miniMap->setView(_view);
+		_miniMap->hide();
+
 		// Widgets
 		innerLayout->addWidget(_topWidget);
 		innerLayout->addWidget(_view, 0, Qt::AlignHCenter | Qt::AlignVCenter);
+		innerLayout->addWidget(_miniMap, 0, Qt::AlignHCenter);
 		mainLayout->addLayout(innerLayout);
 
 		setCentralWidget(centralWidget);
 
-		if (QFile::exists(Save::quickSavePath()))
+		loadSettings();
+
+		initTable();
+		initMenubar();
+		initConnections();
+
+		SaveHeader autoSave;
+		if (Save::readHeader(Save::quickSavePath(), autoSave) && autoSave.state != SaveFormat::Won && autoSave.state != SaveFormat::Lost)
 		{
-			QMessageBox::StandardButton reply =
-				QMessageBox::question(this, tr("Resume Game"), tr("Found auto-saved game. Resume?"), QMessageBox::Yes | QMessageBox::No);
+			QMessageBox::StandardButton reply = QMessageBox::question(this,
+																	  tr("Resume Game"),
+																	  tr("Found auto-saved game (%1 x %2, %3 mines, %4 s). Resume?")
+																		  .arg(autoSave.width)
+																		  .arg(autoSave.height)
+																		  .arg(autoSave.mines)
+																		  .arg(autoSave.elapsed),
+																	  QMessageBox::Yes | QMessageBox::No);
 
 			if (reply == QMessageBox::Yes && _saveSystem.quickLoad())
 			{
-				_model.resetModel(_prefs.width, _prefs.height, _prefs.mine);
+				// The session holds the board as of its journal sequence; the journal holds the
+				// moves logged after it
+				MoveLog log = _saveSystem.loadedLog();
+				_journal.replay(_model.getMineSweeper(), _saveSystem.loadedJournalSequence(), &log.moves);
+				resumeLoaded(log);
+				checkpoint();
 				statusBar()->showMessage(tr("Game resumed from auto-save"), MSG_TIMEOUT);
 			}
 			else
 			{
-				QFile::remove(Save::quickSavePath());
+				_saveSystem.discardQuickSave();
 				newGame();
 			}
 		}
 		else
 		{
+			_saveSystem.discardQuickSave();	   // finished or unreadable, if there at all
 			newGame();
 		}
 
-		loadSettings();
-
-		initTable();
-		initMenubar();
-		_topWidget->setTimer(0);
-		initConnections();
-
 		setWindowIcon(QIcon(QPixmap(DOOM_PATH)));
 		setWindowTitle(APP);
 	}
@@ -110,7 +129,12 @@ namespace SPR
 	{
 		if (_model.isGameInProgress())
 		{
-			_saveSystem.quickSave();
+			checkpoint();
+		}
+		else
+		{
+			_journal.discard();
+			_saveSystem.discardQuickSave();	   // a finished game is not offered on the next start
 		}
 		saveSettings();
 		event->accept();
@@ -153,6 +177,23 @@ namespace SPR
 		saveAsAction->setShortcut(QKeySequence("Ctrl+Shift+L"));
 		connect(loadFrom, &QAction::triggered, this, &MainWindow::loadFrom);
 
+		QAction *compactAction = fileMenu->addAction(tr("Compact Saves"));
+		compactAction->setCheckable(true);
+		compactAction->setChecked(_compactSaves);
+		connect(compactAction, &QAction::triggered, this, &MainWindow::setCompactSaves);
+
+		QAction *importBoardAction = fileMenu->addAction(tr("Import Board"));
+		connect(importBoardAction, &QAction::triggered, this, &MainWindow::importBoard);
+
+		QAction *exportBoardAction = fileMenu->addAction(tr("Export Board"));
+		connect(exportBoardAction, &QAction::triggered, this, &MainWindow::exportBoard);
+
+		QAction *exportAction = fileMenu->addAction(tr("Export Image"));
+		connect(exportAction, &QAction::triggered, this, &MainWindow::exportImage);
+
+		QAction *exportReplayAction = fileMenu->addAction(tr("Export Replay"));
+		connect(exportReplayAction, &QAction::triggered, this, &MainWindow::exportReplay);
+
 		QAction *newGameAction = fileMenu->addAction(tr("&New game"));
 		newGameAction->setShortcut(QKeySequence::New);
 		connect(newGameAction, &QAction::triggered, this, &MainWindow::newGame);
@@ -165,6 +206,21 @@ namespace SPR
 		quitAction->setShortcut(QKeySequence("Esc"));
 		connect(quitAction, &QAction::triggered, qApp, &QApplication::quit);
 
+		QMenu *viewMenu = new QMenu(tr("&View"), this);
+		menuBar()->addMenu(viewMenu);
+
+		QAction *zoomInAction = viewMenu->addAction(tr("Zoom In"));
+		zoomInAction->setShortcut(QKeySequence::ZoomIn);
+		connect(zoomInAction, &QAction::triggered, _view, &BoardView::zoomIn);
+
+		QAction *zoomOutAction = viewMenu->addAction(tr("Zoom Out"));
+		zoomOutAction->setShortcut(QKeySequence::ZoomOut);
+		connect(zoomOutAction, &QAction::triggered, _view, &BoardView::zoomOut);
+
+		QAction *resetZoomAction = viewMenu->addAction(tr("Actual Size"));
+		resetZoomAction->setShortcut(QKeySequence("Ctrl+0"));
+		connect(resetZoomAction, &QAction::triggered, _view, &BoardView::resetZoom);
+
 		QMenu *helpMenu = new QMenu(tr("&Help"), this);
 		menuBar()->addMenu(helpMenu);
 
@@ -178,15 +234,24 @@ namespace SPR
 		debugAction->setCheckable(true);
 		debugAction->setChecked(_debugMode);
 		debugAction->setShortcut(QKeySequence("Ctrl+D"));
-		connect(debugAction, &QAction::triggered, this, &MainWindow::setDebugMode);
+		connect(debugAction,
+				&QAction::triggered,
+				this,
+				[this](bool enabled)
+				{
+					_debugForced = false;	 // chosen in the menu, so it is kept
+					setDebugMode(enabled);
+				});
+		QAction *dumpStatsAction = debugMenu->addAction(tr("Dump Frame Stats"));
+		connect(dumpStatsAction, &QAction::triggered, this, &MainWindow::dumpFrameStats);
 	}
 
 	void MainWindow::initConnections()
 	{
 		// TopWidget
-		connect(_view, &TableView::pressed, _topWidget, &TopWidget::onPressed);
-		connect(_view, &TableView::clicked, _topWidget, &TopWidget::onReleased);
-		connect(_view, &TableView::bothClicked, _topWidget, &TopWidget::onReleased);
+		connect(_view, &BoardView::pressed, _topWidget, &TopWidget::onPressed);
+		connect(_view, &BoardView::clicked, _topWidget, &TopWidget::onReleased);
+		connect(_view, &BoardView::bothClicked, _topWidget, &TopWidget::onReleased);
 		connect(&_timer, &QTimer::timeout, _topWidget, &TopWidget::incrementTimer);
 		connect(&_model, &TableState::mineDisplay, _topWidget, &TopWidget::setMineDisplay);
 		connect(&_model, &TableState::gameLost, _topWidget, &TopWidget::onLost);
@@ -194,21 +259,72 @@ namespace SPR
 		connect(&_model, &TableState::gameStarted, &_timer, [this]() { _timer.start(ONE_SEC_TICK); });
 
 		// TableModel
-		connect(_view, &TableView::clicked, &_model, &TableState::onTableClicked);
-		connect(_view, &TableView::rightClicked, &_model, &TableState::onRightClicked);
-		connect(_view, &TableView::bothClicked, &_model, &TableState::onBothClicked);
-		connect(_view, &TableView::middleClicked, &_model, &TableState::onMiddleClicked);
+		connect(_view, &BoardView::clicked, &_model, &TableState::onTableClicked);
+		connect(_view, &BoardView::rightClicked, &_model, &TableState::onRightClicked);
+		connect(_view, &BoardView::bothClicked, &_model, &TableState::onBothClicked);
+		connect(_view, &BoardView::middleClicked, &_model, &TableState::onMiddleClicked);
+		connect(_view, &BoardView::zoomChanged, this, &MainWindow::updateView);
+
+		// Replay, after the model so the first click lands once the game has started
+		_recorder.attach(_view, &_model);
+
+		// Journal: every recorded move is logged, the board is checkpointed at the start and
+		// every JOURNAL_CHECKPOINT_MOVES moves
+		connect(&_recorder,
+				&ReplayRecorder::recorded,
+				this,
+				[this](const Move &move)
+				{
+					// The model has already applied the move, so a flag's new state can be read back
+					const qint8 flag = move.type == Move::Flag ? _model.getMineSweeper().fieldConst(move.row, move.column).disarmed : qint8(-1);
+					_journal.append(move, flag);
+				});
+		connect(&_model, &TableState::gameStarted, this, &MainWindow::checkpoint);
+		connect(&_journal, &MoveJournal::checkpointDue, this, &MainWindow::checkpoint);
+		connect(&_saveSystem, &Save::quickSaveFlushed, this, &MainWindow::onCheckpointFlushed);
+
+		// Session: changed cells are copied into the mapped session file once the move that
+		// changed them is in the journal, i.e. from the event loop, after the click is handled
+		connect(&_model,
+				&TableState::dataChanged,
+				this,
+				[this](const QModelIndex &topLeft, const QModelIndex &bottomRight)
+				{
+					_saveSystem.markChanged(QRect(QPoint(topLeft.row(), topLeft.column()), QPoint(bottomRight.row(), bottomRight.column())));
+					if (!_sessionSyncQueued)
+					{
+						_sessionSyncQueued = true;
+						QMetaObject::invokeMethod(this, &MainWindow::syncSession, Qt::QueuedConnection);
+					}
+				});
+		connect(&_model, &TableState::layoutChanged, &_saveSystem, &Save::markAllChanged);
+		connect(&_timer, &QTimer::timeout, &_saveSystem, &Save::syncTime);
 
 		// MainWindow
 		connect(&_model, &TableState::gameLost, this, &MainWindow::onGameLost);
 		connect(&_model, &TableState::gameWon, this, &MainWindow::onGameWon);
 		connect(_topWidget, &TopWidget::buttonClicked, this, &MainWindow::newGame);
+
+		// Saves run on a worker thread and report back here
+		connect(&_saveSystem,
+				&Save::saveProgress,
+				this,
+				[this](const QString &, int percent) { statusBar()->showMessage(tr("Saving... %1%").arg(percent)); });
+		connect(&_saveSystem,
+				&Save::saveFinished,
+				this,
+				[this](const QString &filepath, bool ok)
+				{
+					statusBar()->showMessage(ok ? tr("Game saved to %1").arg(filepath) : tr("Could not save %1").arg(filepath), MSG_TIMEOUT);
+				});
 	}
 
 	void MainWindow::newGame()
 	{
 		_topWidget->resetTimer();
 		_model.resetModel(_prefs.height, _prefs.width, _prefs.mine);
+		_recorder.clear();
+		_journal.restart();
 		_view->setModel(&_model);
 		_view->activate();
 		_topWidget->setDefault();
@@ -216,26 +332,32 @@ namespace SPR
 		updateView();
 	}
 
+	// The session is always current, so this only makes sure it is synced; the outcome is
+	// shown once the flush has finished
 	void MainWindow::quickSaveGame()
 	{
-		if (_saveSystem.quickSave())
+		if (checkpoint())
 		{
-			statusBar()->showMessage(_saveSystem.quickSavePath().toStdString().c_str(), MSG_TIMEOUT);
+			_pendingCheckpoints.last().report = true;
+		}
+		else
+		{
+			statusBar()->showMessage(tr("Not saved: cells are still being revealed"), MSG_TIMEOUT);
 		}
 	}
 
 	void MainWindow::saveGameAs()
 	{
-		if (_saveSystem.saveGame())
-		{
-			statusBar()->showMessage(tr("Game saved"), MSG_TIMEOUT);
-		}
+		_saveSystem.saveGame();
 	}
 
 	void MainWindow::quickLoadGame()
 	{
 		if (_saveSystem.quickLoad())
 		{
+			_journal.restart();
+			resumeLoaded(_saveSystem.loadedLog());
+			checkpoint();
 			statusBar()->showMessage(tr("Game loaded"), MSG_TIMEOUT);
 		}
 	}
@@ -244,10 +366,193 @@ namespace SPR
 	{
 		if (_saveSystem.loadGame())
 		{
+			_journal.restart();
+			resumeLoaded(_saveSystem.loadedLog());
+			checkpoint();
 			statusBar()->showMessage(tr("Game loaded"), MSG_TIMEOUT);
 		}
 	}
 
+	// Carries on from whatever board a load left in the model
+	void MainWindow::resumeLoaded(const MoveLog &log)
+	{
+		_model.resumeLoaded();
+		_recorder.resume(log);
+		_view->setModel(&_model);
+		_topWidget->setDefault();
+
+		if (_model.hasLost() || _model.getMineSweeper().checkWinCondition())
+		{
+			_timer.stop();
+			_view->deactivate();
+		}
+		else
+		{
+			_view->activate();
+			if (_model.isGameInProgress())
+			{
+				_timer.start(ONE_SEC_TICK);
+			}
+			else
+			{
+				_timer.stop();
+			}
+		}
+		updateView();
+	}
+
+	// Syncs the session and queues its flush; the journal drops the entries it covers once
+	// the flush is done. Skipped while a flood fill is still running, the next logged move
+	// asks again. False when skipped
+	bool MainWindow::checkpoint()
+	{
+		if (_model.getMineSweeper().hasPendingReveal())
+		{
+			return false;
+		}
+		const qint64 covered = _journal.beginCheckpoint();
+		PendingCheckpoint pending;
+		pending.synced = _saveSystem.quickSave(covered);
+		_pendingCheckpoints.enqueue(pending);
+		_saveSystem.flushQuickSave();	 // even after a failed sync, so the journal hears back in order
+		return true;
+	}
+
+	void MainWindow::onCheckpointFlushed(bool ok)
+	{
+		if (_pendingCheckpoints.isEmpty())
+		{
+			return;
+		}
+
+		const PendingCheckpoint done = _pendingCheckpoints.dequeue();
+		const bool saved = done.synced && ok;
+		_journal.endCheckpoint(saved);
+		if (done.report)
+		{
+			statusBar()->showMessage(saved ? tr("Game saved") : tr("Could not save the game"), MSG_TIMEOUT);
+		}
+	}
+
+	// Between checkpoints the journal keeps its entries and the session follows the board
+	void MainWindow::syncSession()
+	{
+		_sessionSyncQueued = false;
+		if (!_model.getMineSweeper().hasPendingReveal())
+		{
+			_saveSystem.quickSave(_journal.sequence());
+		}
+	}
+
+	// Boards from other tools come without a seed or history and start as they are
+	void MainWindow::importBoard()
+	{
+		QString filename = QFileDialog::getOpenFileName(this,
+														tr("Import Board"),
+														QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+														tr("Boards (*.txt *.mbf)"));
+		if (filename.isEmpty())
+		{
+			return;
+		}
+
+		QString error;
+		if (!BoardIO::read(filename, _model.getMineSweeper(), &error))
+		{
+			statusBar()->showMessage(tr("Could not import %1: %2").arg(filename, error), MSG_TIMEOUT);
+			return;
+		}
+
+		const MineSweeper &board = _model.getMineSweeper();
+		_prefs.width = board.width();
+		_prefs.height = board.height();
+		_prefs.mine = board.totalMineNr();
+		_topWidget->resetTimer();
+		_journal.restart();
+		resumeLoaded();
+		checkpoint();
+		statusBar()->showMessage(tr("Board imported"), MSG_TIMEOUT);
+	}
+
+	void MainWindow::exportBoard()
+	{
+		QString filename = QFileDialog::getSaveFileName(this,
+														tr("Export Board"),
+														QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+														tr("Text boards (*.txt);;MBF boards (*.mbf)"));
+		if (filename.isEmpty())
+		{
+			return;
+		}
+
+		QString error;
+		if (BoardIO::write(filename, _model.getMineSweeper(), &error))
+		{
+			statusBar()->showMessage(tr("Board exported"), MSG_TIMEOUT);
+		}
+		else
+		{
+			statusBar()->showMessage(tr("Could not export %1: %2").arg(filename, error), MSG_TIMEOUT);
+		}
+	}
+
+	// Renders at the current zoom on a worker thread; the renderer keeps its own board copy
+	void MainWindow::exportImage()
+	{
+		QString filename = QFileDialog::getSaveFileName(this,
+														tr("Export Image"),
+														QStandardPaths::writableLocation(QStandardPaths::PicturesLocation),
+														tr("PNG images (*.png)"));
+		if (filename.isEmpty())
+		{
+			return;
+		}
+
+		auto renderer = std::make_shared< BoardRenderer >(_model.getMineSweeper(), !_view->isActive(), _debugMode, _view->cellSize());
+		auto *watcher = new QFutureWatcher< bool >(this);
+		connect(watcher,
+				&QFutureWatcher< bool >::finished,
+				this,
+				[this, watcher]()
+				{
+					statusBar()->showMessage(watcher->result() ? tr("Image exported") : tr("Image export failed"), MSG_TIMEOUT);
+					watcher->deleteLater();
+				});
+		watcher->setFuture(QtConcurrent::run([renderer, filename]() { return renderer->exportPng(filename); }));
+		statusBar()->showMessage(tr("Exporting image..."));
+	}
+
+	// Frames go into a directory of numbered PNGs plus a playlist with the move timing
+	void MainWindow::exportReplay()
+	{
+		if (!_recorder.isRecording())
+		{
+			statusBar()->showMessage(tr("Nothing to replay yet"), MSG_TIMEOUT);
+			return;
+		}
+
+		QString directory = QFileDialog::getExistingDirectory(this,
+															  tr("Export Replay"),
+															  QStandardPaths::writableLocation(QStandardPaths::PicturesLocation));
+		if (directory.isEmpty())
+		{
+			return;
+		}
+
+		auto replay = std::make_shared< ReplayRenderer >(_recorder.startBoard(), _recorder.moves(), _debugMode);
+		auto *watcher = new QFutureWatcher< bool >(this);
+		connect(watcher,
+				&QFutureWatcher< bool >::finished,
+				this,
+				[this, watcher]()
+				{
+					statusBar()->showMessage(watcher->result() ? tr("Replay exported") : tr("Replay export failed"), MSG_TIMEOUT);
+					watcher->deleteLater();
+				});
+		watcher->setFuture(QtConcurrent::run([replay, directory]() { return replay->renderTo(directory); }));
+		statusBar()->showMessage(tr("Exporting replay..."));
+	}
+
 	void MainWindow::onGameLost()
 	{	 // TODO: save stats
 		_timer.stop();
@@ -279,6 +584,7 @@ namespace SPR
 	void MainWindow::updateView()
 	{
 		_view->adjustSizeToContents();
+		_miniMap->setVisible(_view->needsScrolling());
 		layout()->setSizeConstraint(QLayout::SetFixedSize);
 	}
 
@@ -288,8 +594,8 @@ namespace SPR
 		_prefs.width = settings.value("width", int(DEFAULT_WIDTH)).toInt();
 		_prefs.height = settings.value("height", int(DEFAULT_HEIGHT)).toInt();
 		_prefs.mine = settings.value("mine", int(DEFAULT_MINE)).toInt();
-		_debugMode = settings.value("debugMode", false).toBool();
-		setDebugMode(_debugMode);
+		setDebugMode(_debugForced || settings.value("debugMode", false).toBool());	  // -dbg wins over settings
+		setCompactSaves(settings.value("compactSaves", false).toBool());
 	}
 
 	void MainWindow::saveSettings()
@@ -298,18 +604,56 @@ namespace SPR
 		settings.setValue("width", _prefs.width);
 		settings.setValue("height", _prefs.height);
 		settings.setValue("mine", _prefs.mine);
-		settings.setValue("debugMode", _debugMode);
+		if (!_debugForced)
+		{
+			settings.setValue("debugMode", _debugMode);
+		}
+		settings.setValue("compactSaves", _compactSaves);
 	}
 
 	void MainWindow::setDebugMode(bool enabled)
 	{
 		_debugMode = enabled;
 		_model.setDebugMode(enabled);
+		_frameStats.setEnabled(enabled);
+		_view->setFrameStats(enabled ? &_frameStats : nullptr);
+		_view->setLatencyTracker(enabled ? &_latency : nullptr);
+		_model.setLatencyTracker(enabled ? &_latency : nullptr);
+		_latency.setLogFile(enabled ? QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/latency.log" : QString());
 		statusBar()->showMessage(enabled ? "Debug mode ON" : "Debug mode OFF", TWO_SEC_TIMEOUT);
 	}
 
+	// Games generated here are then saved as their seed and moves
+	void MainWindow::setCompactSaves(bool enabled)
+	{
+		_compactSaves = enabled;
+		_saveSystem.setMoveLog(enabled ? &_recorder.log() : nullptr);
+	}
+
+	void MainWindow::dumpFrameStats()
+	{
+		QString filename = QFileDialog::getSaveFileName(this,
+														tr("Dump Frame Stats"),
+														QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+														tr("CSV files (*.csv)"));
+		if (filename.isEmpty())
+		{
+			return;
+		}
+
+		if (_frameStats.dump(filename))
+		{
+			statusBar()->showMessage(tr("Frame stats written"), MSG_TIMEOUT);
+		}
+	}
+
 	bool MainWindow::isDebugMode() const
 	{
 		return _debugMode;
 	}
+
+	void MainWindow::waitForSaves()
+	{
+		_saveSystem.waitForSaves();
+	}
 }	 // namespace SPR
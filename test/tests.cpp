@@ -2,26 +2,46 @@
 
 #define private public
 #include "include/Save.h"
+#include "include/SaveFormat.h"
 #include "include/TableState.h"
 #undef private
 
+#include "include/BoardCorpus.h"
+#include "include/BoardIO.h"
+#include "include/BoardRenderer.h"
+#include "include/CellAtlas.h"
 #include "include/Constants.h"
+#include "include/FrameStats.h"
+#include "include/LatencyTracker.h"
+#include "include/LegacyIniReader.h"
+#include "include/MoveJournal.h"
+#include "include/PngWriter.h"
+#include "include/ReplayRecorder.h"
+#include "include/ReplayRenderer.h"
+#include "include/SaveIndex.h"
+#include "include/SessionFile.h"
 #include "include/Preferences.h"
 #include "include/mainwindow.h"
 
 #include "gtest/gtest.h"
 
 #include <QApplication>
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QModelIndex>
 #include <QSettings>
 #include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTemporaryFile>
+#include <QTest>
 #include <QTimer>
 #include <QVariant>
+#include <numeric>
 
 using namespace SPR;
 
@@ -1093,7 +1113,7 @@ TEST_F(TableStateTest, DataReturnsCorrectVariantForCell)
 
 	// Получаем данные для конкретной ячейки
 	QModelIndex index = tableState->index(1, 1);
-	QVariant data = tableState->data(index, Qt::DisplayRole);
+	QVariant data = tableState->data(index, Qt::UserRole);
 
 	// Проверяем, что данные корректно возвращаются
 	EXPECT_TRUE(data.isValid());
@@ -1236,7 +1256,7 @@ TEST_F(TableStateTest, DebugModeAddsDebugInfoToField)
 	tableState->setDebugMode(true);
 
 	QModelIndex index = tableState->index(1, 1);
-	QVariant variant = tableState->data(index, Qt::DisplayRole);
+	QVariant variant = tableState->data(index, Qt::UserRole);
 	GameField field = variant.value< GameField >();
 
 	// Проверяем, что для режима отладки установлено значение isDebug = true
@@ -1431,6 +1451,95 @@ TEST_F(TableStateTest, RightClickIncreasesMineDisplayWhenFlaggingCell)
 	EXPECT_EQ(mineDisplaySpy.count(), 1);
 }
 
+TEST_F(TableStateTest, DataIgnoresUnusedRoles)
+{
+	tableState->resetModel(4, 4, 1);
+	QModelIndex index = tableState->index(1, 1);
+
+	EXPECT_FALSE(tableState->data(index, Qt::DisplayRole).isValid());
+	EXPECT_FALSE(tableState->data(index, Qt::DecorationRole).isValid());
+	EXPECT_FALSE(tableState->data(index, Qt::SizeHintRole).isValid());
+	EXPECT_FALSE(tableState->data(QModelIndex(), Qt::UserRole).isValid());
+}
+
+TEST_F(TableStateTest, CellReturnsBoardStorage)
+{
+	tableState->resetModel(4, 4, 1);
+	tableState->getMineSweeper().field(2, 3).neighbours = 5;
+
+	EXPECT_EQ(&tableState->cell(2, 3), &tableState->getMineSweeper().fieldConst(2, 3));
+	EXPECT_EQ(tableState->cell(2, 3).neighbours, 5);
+}
+
+TEST_F(TableStateTest, LargeRevealReportsWinOnlyWhenComplete)
+{
+	tableState->resetModel(1000, 1000, 0);
+	tableState->setFrameBudget(0);	  // one REVEAL_BATCH per turn
+	QSignalSpy wonSpy(tableState, &TableState::gameWon);
+
+	tableState->onTableClicked(tableState->index(0, 0));
+	ASSERT_TRUE(tableState->getMineSweeper().hasPendingReveal());
+	EXPECT_EQ(wonSpy.count(), 0);
+
+	while (tableState->getMineSweeper().hasPendingReveal())
+	{
+		QCoreApplication::processEvents();
+	}
+
+	EXPECT_EQ(wonSpy.count(), 1);
+	EXPECT_TRUE(tableState->getMineSweeper().getDiscovered(999, 999));
+}
+
+TEST_F(MineSweeperTest, RevealPendingStopsAtBatchSize)
+{
+	game.reset(10, 10, 0);
+	game.populate(0, 0);
+	game.queueReveal(5, 5);
+
+	QRect changed;
+	EXPECT_EQ(game.revealPending(3, changed), 3);
+	EXPECT_TRUE(game.hasPendingReveal());
+
+	while (game.hasPendingReveal())
+	{
+		game.revealPending(REVEAL_BATCH, changed);
+	}
+	EXPECT_EQ(changed, QRect(0, 0, 10, 10));
+	EXPECT_TRUE(game.checkWinCondition());
+	EXPECT_FALSE(game.mineRevealed());
+}
+
+TEST_F(MineSweeperTest, FloodDoesNotOpenFlaggedCells)
+{
+	game.reset(5, 5, 0);
+	game.populate(0, 0);
+	game.disarm(4, 4);
+	game.queueReveal(0, 0);
+
+	QRect changed;
+	game.revealPending(REVEAL_BATCH, changed);
+	EXPECT_FALSE(game.getDiscovered(4, 4));
+	EXPECT_TRUE(game.getDiscovered(3, 3));
+}
+
+TEST_F(MineSweeperTest, ChordRequiresMatchingFlags)
+{
+	game.reset(3, 3, 0);
+	game.field(0, 0).mine = 1;
+	game.field(1, 1).neighbours = 1;
+	game.discover(1, 1);
+
+	EXPECT_FALSE(game.queueChord(1, 1));
+	game.disarm(0, 0);
+	EXPECT_TRUE(game.queueChord(1, 1));
+
+	QRect changed;
+	game.revealPending(REVEAL_BATCH, changed);
+	EXPECT_TRUE(game.getDiscovered(2, 2));
+	EXPECT_FALSE(game.getDiscovered(0, 0));
+	EXPECT_FALSE(game.mineRevealed());
+}
+
 class DummyTopWidget : public SPR::TopWidget
 {
   public:
@@ -3384,6 +3493,1618 @@ TEST(SaveTest, SaveLoadWithMultipleFieldChanges)
 	EXPECT_TRUE(loaded.field(3, 0).disarmed);
 }
 
+TEST(SaveTest, BinaryFormatIsCompactAndVersioned)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(100, 100, 1500);
+	game.populate(0, 0);
+	game.discover(0, 0);
+
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	QString path = "test/testsave.ini";
+	ASSERT_TRUE(saver.serialize(path));
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+	EXPECT_TRUE(SaveFormat::isBinary(&file));
+	EXPECT_LT(file.size(), 16 * 1024);
+
+	QDataStream in(&file);
+	quint32 magic = 0;
+	quint16 version = 0;
+	in >> magic >> version;
+	EXPECT_EQ(magic, SaveFormat::MAGIC);
+	EXPECT_EQ(version, SaveFormat::VERSION);
+}
+
+TEST(SaveTest, LegacyIniSaveStillLoads)
+{
+	QString path = "test/testsave.ini";
+	QFile::remove(path);
+	{
+		QSettings settings(path, QSettings::IniFormat);
+		settings.setValue("Game/width", 2);
+		settings.setValue("Game/height", 1);
+		settings.setValue("Game/mine", 1);
+		settings.setValue("Timer/elapsed", 42);
+		settings.setValue("Board/Cell_0_0/mine", 1);
+		settings.setValue("Board/Cell_1_0/discovered", 1);
+		settings.setValue("Board/Cell_1_0/neighbours", 1);
+	}
+
+	MineSweeper loaded;
+	Preferences prefs;
+	QTimer t;
+	Save loader(loaded, t, prefs);
+	DummyTopWidget dummy;
+	loader.setTopWidget(&dummy);
+	ASSERT_TRUE(loader.deserialize(path));
+
+	EXPECT_EQ(loaded.width(), 2);
+	EXPECT_EQ(loaded.getMine(0, 0), 1);
+	EXPECT_TRUE(loaded.getDiscovered(1, 0));
+	EXPECT_EQ(loaded.getNeighbours(1, 0), 1);
+	EXPECT_TRUE(loaded.checkWinCondition());	// discovered count came back too
+}
+
+TEST(SaveTest, LargeBoardRoundTripsThroughCompressedChunks)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(3000, 1000, 300000);
+	game.populate(0, 0);
+	game.disarm(2999, 999);
+	game.discover(1500, 500);
+
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	QString path = "test/testsave.ini";
+	ASSERT_TRUE(saver.serialize(path));
+	EXPECT_LT(QFileInfo(path).size(), game.size() / 2);	 // below the raw packed planes
+
+	MineSweeper loaded;
+	Preferences p;
+	QTimer t;
+	Save loader(loaded, t, p);
+	loader.setTopWidget(&dummy);
+	ASSERT_TRUE(loader.deserialize(path));
+
+	ASSERT_EQ(loaded.size(), game.size());
+	for (int y = 0; y < game.height(); ++y)
+	{
+		for (int x = 0; x < game.width(); ++x)
+		{
+			const GameField& orig = game.fieldConst(x, y);
+			const GameField& copy = loaded.fieldConst(x, y);
+			ASSERT_TRUE(orig.mine == copy.mine && orig.discovered == copy.discovered && orig.disarmed == copy.disarmed
+						&& orig.neighbours == copy.neighbours)
+				<< "Mismatch at (" << x << ", " << y << ")";
+		}
+	}
+}
+
+TEST(SaveTest, RawRecordsLoadFromMappedFileAndBuffer)
+{
+	MineSweeper game;
+	game.reset(40, 30, 120);
+	game.populate(0, 0);
+	game.discover(0, 0);
+	game.disarm(39, 29);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("records.sav");
+	{
+		QFile file(path);
+		ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+		ASSERT_TRUE(SaveFormat::write(&file, game, 7, false, SaveFormat::Records));
+	}
+
+	MineSweeper loaded;
+	Preferences prefs;
+	QTimer t;
+	Save loader(loaded, t, prefs);
+	DummyTopWidget dummy;
+	loader.setTopWidget(&dummy);
+	ASSERT_TRUE(loader.deserialize(path));
+	ASSERT_EQ(loaded.size(), game.size());
+	EXPECT_EQ(memcmp(loaded.cells(), game.cells(), game.size() * sizeof(GameField)), 0);
+	EXPECT_EQ(loaded.checkWinCondition(), game.checkWinCondition());
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+	QBuffer buffer;
+	buffer.setData(file.readAll());
+	buffer.open(QIODevice::ReadOnly);
+
+	MineSweeper fromBuffer;
+	SaveHeader header;
+	ASSERT_TRUE(SaveFormat::read(&buffer, fromBuffer, header));
+	EXPECT_EQ(header.encoding, SaveFormat::Records);
+	EXPECT_EQ(header.elapsed, 7);
+	EXPECT_EQ(memcmp(fromBuffer.cells(), game.cells(), game.size() * sizeof(GameField)), 0);
+}
+
+TEST(SaveTest, RawRecordsDropHighlights)
+{
+	MineSweeper game;
+	game.reset(8, 8, 10);
+	game.populate(0, 0);
+	game.markTemporary(4, 4);	 // a middle click was held while saving
+	game.field(5, 5).isDebug = true;
+
+	QBuffer buffer;
+	buffer.open(QIODevice::ReadWrite);
+	ASSERT_TRUE(SaveFormat::write(&buffer, game, 0, false, SaveFormat::Records));
+	buffer.seek(0);
+
+	MineSweeper loaded;
+	SaveHeader header;
+	ASSERT_TRUE(SaveFormat::read(&buffer, loaded, header));
+	for (long long i = 0; i < loaded.size(); ++i)
+	{
+		ASSERT_FALSE(loaded.cells()[i].isHighlighted);
+		ASSERT_FALSE(loaded.cells()[i].isDebug);
+	}
+}
+
+TEST(SaveTest, OversizedHeaderIsRejectedBeforeAllocating)
+{
+	SaveHeader claimed;
+	claimed.version = SaveFormat::VERSION;
+	claimed.width = 100000;
+	claimed.height = 100000;
+	claimed.mines = 1;
+	QByteArray bytes = SaveFormat::encodeHeader(claimed);	 // a well-formed header, crc included
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+
+	MineSweeper board;
+	SaveHeader header;
+	EXPECT_FALSE(SaveFormat::read(&buffer, board, header));
+	EXPECT_EQ(board.size(), 0);	   // never reset to the claimed size
+
+	EXPECT_TRUE(MineSweeper::fitsBoard(3000, 1000));
+	EXPECT_FALSE(MineSweeper::fitsBoard(65536, 65536));	   // past int, let alone the limit
+	EXPECT_FALSE(MineSweeper::fitsBoard(0, 10));
+}
+
+TEST(SaveTest, OnlyTheCurrentBinaryVersionIsRead)
+{
+	SaveHeader forged;
+	forged.version = SaveFormat::VERSION + 1;
+	forged.width = 10;
+	forged.height = 10;
+	forged.mines = 10;
+	forged.payloadSize = 1 << 20;	 // never checked if the header were trusted
+	QByteArray bytes = SaveFormat::encodeHeader(forged);
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	EXPECT_FALSE(SaveFormat::verify(&buffer));
+
+	forged.version = SaveFormat::VERSION;
+	bytes = SaveFormat::encodeHeader(forged);
+	buffer.seek(0);
+	EXPECT_FALSE(SaveFormat::verify(&buffer));	  // right version, payload missing
+}
+
+TEST(SaveTest, PlaneLargerThanBoardIsRejected)
+{
+	MineSweeper game;
+	game.reset(10, 10, 10);
+	game.populate(0, 0);
+
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	ASSERT_TRUE(SaveFormat::write(&buffer, game, 0, false, SaveFormat::Planes));
+	QByteArray bytes = buffer.data();
+
+	// The first plane's length follows the header: 100 one-bit cells
+	uchar *planeSize = reinterpret_cast< uchar * >(bytes.data() + SaveFormat::HEADER_SIZE);
+	ASSERT_EQ(qFromBigEndian< qint64 >(planeSize), 13);
+	qToBigEndian< qint64 >(qint64(1) << 40, planeSize);
+
+	QBuffer tampered(&bytes);
+	tampered.open(QIODevice::ReadOnly);
+	MineSweeper loaded;
+	SaveHeader header;
+	EXPECT_FALSE(SaveFormat::read(&tampered, loaded, header));
+}
+
+TEST(SaveTest, AsyncSaveWritesSnapshotAndReports)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(10, 10, 5);
+	game.disarm(3, 3);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("async.sav");
+
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	QSignalSpy progress(&saver, &Save::saveProgress);
+	QSignalSpy finished(&saver, &Save::saveFinished);
+
+	saver.saveAsync(path);
+	game.disarm(4, 4);	  // after the snapshot, must not reach the file
+	saver.waitForSaves();
+
+	EXPECT_FALSE(saver.isSaving());
+	ASSERT_EQ(finished.count(), 1);
+	EXPECT_EQ(finished[0][0].toString(), path);
+	EXPECT_TRUE(finished[0][1].toBool());
+	ASSERT_GE(progress.count(), 1);
+	EXPECT_EQ(progress.last()[1].toInt(), 100);
+	EXPECT_EQ(QDir(dir.path()).entryList(QDir::Files), QStringList{ "async.sav" });	// no temporary left
+
+	MineSweeper loaded;
+	Preferences p;
+	QTimer t;
+	Save loader(loaded, t, p);
+	loader.setTopWidget(&dummy);
+	ASSERT_TRUE(loader.deserialize(path));
+	EXPECT_EQ(loaded.getFlag(3, 3), FIELD_VISITED);
+	EXPECT_EQ(loaded.getFlag(4, 4), FIELD_NOT_VISITED);
+}
+
+TEST(SaveTest, SaveDuringRevealHoldsTheWholeFloodFill)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(100, 100, 0);
+	game.populate(0, 0);
+	game.queueReveal(0, 0);
+	QRect changed;
+	game.revealPending(10, changed);	// the first slice only
+	ASSERT_TRUE(game.hasPendingReveal());
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("reveal.sav");
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	saver.saveAsync(path);
+	saver.waitForSaves();
+
+	MineSweeper loaded;
+	Preferences p;
+	QTimer t;
+	Save loader(loaded, t, p);
+	loader.setTopWidget(&dummy);
+	ASSERT_TRUE(loader.deserialize(path));
+	EXPECT_EQ(loaded.discoveredCount(), 100 * 100);
+	EXPECT_TRUE(loaded.checkWinCondition());
+}
+
+TEST_F(MineSweeperTest, SameSeedAndFirstClickGiveSameBoard)
+{
+	game.reset(30, 20, 100);
+	game.setSeed(1234);
+	game.populate(7, 3);
+
+	MineSweeper other;
+	other.reset(30, 20, 100);
+	EXPECT_FALSE(other.isGenerated());
+	other.setSeed(1234);
+	other.populate(7, 3);
+
+	EXPECT_TRUE(other.isGenerated());
+	EXPECT_EQ(other.firstClick(), QPoint(7, 3));
+	for (int x = 0; x < 30; ++x)
+	{
+		for (int y = 0; y < 20; ++y)
+		{
+			EXPECT_EQ(game.getMine(x, y), other.getMine(x, y));
+		}
+	}
+}
+
+TEST(SaveTest, SeedAndMovesSaveRebuildsBoard)
+{
+	MoveLog log;
+	log.start.reset(2000, 1000, 50000);
+	log.start.disarm(1999, 999);	// flagged before the first click
+	log.start.populate(10, 10);
+	log.moves.append(Move{ Move::Reveal, 10, 10, 0 });
+	log.moves.append(Move{ Move::Flag, 500, 500, 100 });
+
+	MineSweeper board = log.start;
+	for (const Move &move : log.moves)
+	{
+		board.applyMove(move);
+	}
+	ASSERT_TRUE(SaveFormat::reproduces(log, board));
+
+	QBuffer buffer;
+	buffer.open(QIODevice::ReadWrite);
+	ASSERT_TRUE(SaveFormat::writeMoves(&buffer, board, log, 42, true, 7));
+	EXPECT_LT(buffer.size(), 128);
+
+	buffer.seek(0);
+	MineSweeper loaded;
+	SaveHeader header;
+	MoveLog loadedLog;
+	ASSERT_TRUE(SaveFormat::read(&buffer, loaded, header, &loadedLog));
+	EXPECT_EQ(header.encoding, SaveFormat::Moves);
+	EXPECT_EQ(header.elapsed, 42);
+	EXPECT_EQ(header.journalSequence, 7);
+	EXPECT_EQ(loadedLog.moves.size(), 2);
+	EXPECT_TRUE(SaveFormat::reproduces(loadedLog, loaded));
+	EXPECT_EQ(0, memcmp(loaded.cells(), board.cells(), board.size() * sizeof(GameField)));
+	EXPECT_EQ(loaded.getFlag(1999, 999), FIELD_VISITED);
+}
+
+TEST(SaveTest, BoardNotFromSeedIsSavedInFull)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(10, 10, 1);
+	game.field(2, 2).mine = 1;	  // laid by hand, no seed reproduces it
+
+	MoveLog log;
+	log.start = game;
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	saver.setMoveLog(&log);
+	QString path = "test/testsave.ini";
+	ASSERT_TRUE(saver.serialize(path));
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+	MineSweeper loaded;
+	SaveHeader header;
+	ASSERT_TRUE(SaveFormat::read(&file, loaded, header));
+	EXPECT_NE(header.encoding, SaveFormat::Moves);
+	EXPECT_EQ(loaded.getMine(2, 2), 1);
+
+	// A generated board whose cells were changed outside the log is saved in full too
+	log.start.reset(10, 10, 3);
+	log.start.populate(0, 0);
+	game = log.start;
+	game.disarm(5, 5);
+	ASSERT_TRUE(saver.serialize(path));
+	file.close();
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+	ASSERT_TRUE(SaveFormat::read(&file, loaded, header));
+	EXPECT_NE(header.encoding, SaveFormat::Moves);
+	EXPECT_EQ(loaded.getFlag(5, 5), FIELD_VISITED);
+}
+
+TEST(SaveTest, HeaderIsReadWithoutTheBoard)
+{
+	MineSweeper game;
+	game.reset(300, 200, 900);
+	game.setSeed(99);
+	game.populate(5, 5);
+	game.discover(5, 5);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("header.sav");
+	{
+		QFile file(path);
+		ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+		ASSERT_TRUE(SaveFormat::write(&file, game, 61, true));
+	}
+
+	SaveHeader header;
+	ASSERT_TRUE(Save::readHeader(path, header));
+	EXPECT_EQ(header.version, SaveFormat::VERSION);
+	EXPECT_EQ(header.width, 300);
+	EXPECT_EQ(header.height, 200);
+	EXPECT_EQ(header.mines, 900);
+	EXPECT_EQ(header.elapsed, 61);
+	EXPECT_EQ(header.state, SaveFormat::InProgress);
+	EXPECT_EQ(header.seed, 99u);
+	EXPECT_EQ(header.payloadSize, QFileInfo(path).size() - SaveFormat::HEADER_SIZE);
+	EXPECT_TRUE(Save::verify(path));
+
+	Preferences prefs;
+	QTimer timer;
+	Save saver(game, timer, prefs);
+	EXPECT_EQ(saver.getElapsedTime(path), 61);
+}
+
+TEST(SaveTest, CorruptedPayloadFailsVerification)
+{
+	MineSweeper game;
+	game.reset(50, 50, 200);
+	game.populate(0, 0);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("corrupt.sav");
+	{
+		QFile file(path);
+		ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+		ASSERT_TRUE(SaveFormat::write(&file, game, 0, false));
+	}
+	ASSERT_TRUE(Save::verify(path));
+
+	{
+		QFile file(path);
+		ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+		ASSERT_TRUE(file.seek(file.size() - 1));
+		char last = 0;
+		ASSERT_TRUE(file.getChar(&last));
+		ASSERT_TRUE(file.seek(file.size() - 1));
+		ASSERT_TRUE(file.putChar(char(last ^ 0x5a)));
+	}
+
+	SaveHeader header;
+	EXPECT_TRUE(Save::readHeader(path, header));	// the header itself is intact
+	EXPECT_FALSE(Save::verify(path));
+
+	MineSweeper loaded;
+	Preferences prefs;
+	QTimer timer;
+	Save loader(loaded, timer, prefs);
+	DummyTopWidget dummy;
+	loader.setTopWidget(&dummy);
+	EXPECT_FALSE(loader.deserialize(path));
+}
+
+TEST(SaveTest, StreamingIniReaderMatchesQSettingsSave)
+{
+	MineSweeper game;
+	game.reset(12, 7, 10);
+	game.populate(3, 3);
+	game.discover(3, 3);
+	game.disarm(11, 6);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("legacy.ini");
+	{
+		QSettings settings(path, QSettings::IniFormat);	   // as the INI save used to be written
+		settings.setValue("Game/width", game.width());
+		settings.setValue("Game/height", game.height());
+		settings.setValue("Game/mine", game.totalMineNr());
+		settings.setValue("Timer/elapsed", 17);
+		settings.setValue("Timer/running", true);
+		for (int y = 0; y < game.height(); ++y)
+		{
+			for (int x = 0; x < game.width(); ++x)
+			{
+				const QString cell = QString("Board/Cell_%1_%2/").arg(x).arg(y);
+				const GameField &field = game.fieldConst(x, y);
+				settings.setValue(cell + "mine", field.mine);
+				settings.setValue(cell + "discovered", field.discovered);
+				settings.setValue(cell + "disarmed", field.disarmed);
+				settings.setValue(cell + "neighbours", field.neighbours);
+			}
+		}
+	}
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+	MineSweeper loaded;
+	SaveHeader header;
+	QString error;
+	ASSERT_TRUE(LegacyIniReader::read(&file, loaded, header, true, &error)) << error.toStdString();
+	EXPECT_EQ(header.elapsed, 17);
+	EXPECT_TRUE(header.timerRunning);
+	ASSERT_EQ(loaded.size(), game.size());
+	EXPECT_EQ(memcmp(loaded.cells(), game.cells(), game.size() * sizeof(GameField)), 0);
+	EXPECT_EQ(loaded.discoveredCount(), game.discoveredCount());
+}
+
+TEST(SaveTest, StreamingIniReaderRejectsWrongNeighbourCount)
+{
+	QBuffer buffer;
+	buffer.setData("[Board]\n"
+				   "Cell_0_0\\mine=1\n"
+				   "Cell_1_0\\neighbours=2\n"
+				   "\n"
+				   "[Game]\n"
+				   "height=1\n"
+				   "mine=1\n"
+				   "width=2\n");
+	ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+
+	MineSweeper loaded;
+	SaveHeader header;
+	QString error;
+	EXPECT_FALSE(LegacyIniReader::read(&buffer, loaded, header, true, &error));
+	EXPECT_TRUE(error.contains("1,0"));
+
+	buffer.seek(0);
+	ASSERT_TRUE(LegacyIniReader::read(&buffer, loaded, header, false));
+	EXPECT_EQ(loaded.getNeighbours(1, 0), 2);
+}
+
+TEST(SaveTest, StreamingIniReaderRejectsOversizedBoard)
+{
+	QBuffer buffer;
+	buffer.setData("[Game]\n"
+				   "height=100000\n"
+				   "mine=1\n"
+				   "width=100000\n");
+	ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+
+	MineSweeper loaded;
+	SaveHeader header;
+	QString error;
+	EXPECT_FALSE(LegacyIniReader::read(&buffer, loaded, header, false, &error));
+	EXPECT_TRUE(error.contains("[Game] size"));
+	EXPECT_EQ(loaded.size(), 0);
+}
+
+TEST(SaveTest, DiscardQuickSaveLeavesNothingToResume)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(5, 5, 3);
+	game.populate(0, 0);
+
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	ASSERT_TRUE(saver.quickSave());
+	{
+		QFile older(FileFormat::LEGACY_QUICKSAVE_FILE);	   // as an older build would have left it
+		ASSERT_TRUE(older.open(QIODevice::WriteOnly));
+	}
+
+	saver.discardQuickSave();
+	EXPECT_FALSE(QFile::exists(FileFormat::SESSION_FILE));
+	EXPECT_FALSE(QFile::exists(FileFormat::LEGACY_QUICKSAVE_FILE));
+	SaveHeader header;
+	EXPECT_FALSE(Save::readHeader(Save::quickSavePath(), header));
+}
+
+TEST(SaveTest, TruncatedBinarySaveIsRejected)
+{
+	MineSweeper game;
+	Preferences prefs;
+	QTimer timer;
+	game.reset(8, 8, 10);
+
+	Save saver(game, timer, prefs);
+	DummyTopWidget dummy;
+	saver.setTopWidget(&dummy);
+	QString path = "test/testsave.ini";
+	ASSERT_TRUE(saver.serialize(path));
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+	ASSERT_TRUE(file.resize(file.size() - 3));
+	file.close();
+
+	MineSweeper loaded;
+	loaded.reset(3, 3, 1);
+	Preferences p;
+	QTimer t;
+	Save loader(loaded, t, p);
+	loader.setTopWidget(&dummy);
+	EXPECT_FALSE(loader.deserialize(path));
+	EXPECT_EQ(loaded.width(), 3);	 // a failed load leaves the game alone
+}
+
+TEST(CellAtlasTest, StripHoldsEverySprite)
+{
+	CellAtlas atlas(FIELD_SIZE, 1.0, QApplication::style());
+
+	EXPECT_EQ(atlas.image().width(), FIELD_SIZE * static_cast< int >(CellSprite::Count));
+	EXPECT_EQ(atlas.image().height(), FIELD_SIZE);
+	EXPECT_EQ(atlas.sourceRect(CellSprite::Flag), QRect(FIELD_SIZE * static_cast< int >(CellSprite::Flag), 0, FIELD_SIZE, FIELD_SIZE));
+}
+
+TEST(CellAtlasTest, SharedAtlasIsBuiltOncePerRatio)
+{
+	const CellAtlas& first = CellAtlas::shared(FIELD_SIZE, 1.0);
+	const CellAtlas& second = CellAtlas::shared(FIELD_SIZE, 1.0);
+	const CellAtlas& retina = CellAtlas::shared(FIELD_SIZE, 2.0);
+
+	EXPECT_EQ(&first, &second);
+	EXPECT_NE(&first, &retina);
+	EXPECT_EQ(retina.image().height(), FIELD_SIZE * 2);
+}
+
+TEST(CellAtlasTest, ActiveDelegatePicksSprites)
+{
+	ActiveDelegate delegate;
+	GameField field;
+	EXPECT_EQ(delegate.spriteForField(field), CellSprite::Raised);
+
+	field.disarmed = 1;
+	EXPECT_EQ(delegate.spriteForField(field), CellSprite::Flag);
+
+	field.disarmed = 0;
+	field.discovered = 1;
+	field.neighbours = 3;
+	EXPECT_EQ(delegate.spriteForField(field), CellSprite::Number3);
+}
+
+TEST(CellAtlasTest, InactiveDelegateRevealsWrongFlags)
+{
+	InactiveDelegate delegate;
+	GameField field;
+	field.disarmed = 1;
+	EXPECT_EQ(delegate.spriteForField(field), CellSprite::WrongFlag);
+
+	field.mine = 1;
+	EXPECT_EQ(delegate.spriteForField(field), CellSprite::Flag);
+}
+
+TEST(BoardViewTest, IndexAtMapsPositionsArithmetically)
+{
+	TableState state;
+	state.resetModel(4, 6, 1);
+
+	BoardView view;
+	view.setModel(&state);
+	view.adjustSizeToContents();
+
+	QModelIndex index = view.indexAt(QPoint(FIELD_SIZE * 2 + 1, FIELD_SIZE + 1));
+	ASSERT_TRUE(index.isValid());
+	EXPECT_EQ(index.row(), 1);
+	EXPECT_EQ(index.column(), 2);
+
+	EXPECT_FALSE(view.indexAt(QPoint(FIELD_SIZE * 6 + 1, 0)).isValid());
+	EXPECT_FALSE(view.indexAt(QPoint(-1, 0)).isValid());
+}
+
+TEST(BoardViewTest, VisualRectMatchesIndexAt)
+{
+	TableState state;
+	state.resetModel(3, 3, 1);
+
+	BoardView view;
+	view.setModel(&state);
+	view.adjustSizeToContents();
+
+	const QRect rect = view.visualRect(2, 1);
+	EXPECT_EQ(rect.size(), QSize(FIELD_SIZE, FIELD_SIZE));
+	EXPECT_EQ(view.indexAt(rect.center()), state.index(2, 1));
+}
+
+TEST(BoardViewTest, DataChangedRepaintsCachedTiles)
+{
+	TableState state;
+	MineSweeper &board = state.getMineSweeper();
+	board.reset(10, 10, 0);
+	board.field(0, 0).mine = 1;
+	board.field(9, 9).mine = 1;
+	board.recountMines();
+	board.discover(1, 1);
+	board.discover(8, 8);
+	state.resumeLoaded();
+
+	BoardView view;
+	view.setModel(&state);
+	view.setCellSize(4);	// flat colours, one per cell
+	view.resize(100, 100);
+	auto colorAt = [&view](int row, int column) { return view.viewport()->grab().toImage().pixel(column * 4 + 2, row * 4 + 2); };
+
+	EXPECT_EQ(colorAt(2, 2), flatColor(CellSprite::Raised));	// the tile is cached from here on
+
+	state.onMiddleClicked(state.index(1, 1));
+	EXPECT_EQ(colorAt(2, 2), flatColor(CellSprite::Highlight));
+
+	// A second middle click before the timeout also repaints the first highlight
+	state.onMiddleClicked(state.index(8, 8));
+	EXPECT_EQ(colorAt(2, 2), flatColor(CellSprite::Raised));
+	EXPECT_EQ(colorAt(7, 7), flatColor(CellSprite::Highlight));
+}
+
+TEST(BoardViewTest, ZoomStepsThroughLevels)
+{
+	TableState state;
+	state.resetModel(10, 10, 5);
+
+	BoardView view;
+	view.setModel(&state);
+	QSignalSpy zoomSpy(&view, &BoardView::zoomChanged);
+
+	view.zoomIn();
+	EXPECT_EQ(view.cellSize(), 32);
+	view.zoomOut();
+	view.zoomOut();
+	EXPECT_EQ(view.cellSize(), 16);
+	view.resetZoom();
+	EXPECT_EQ(view.cellSize(), FIELD_SIZE);
+	EXPECT_EQ(zoomSpy.count(), 4);
+
+	view.setCellSize(ZOOM_LEVELS[0]);
+	view.zoomOut();
+	EXPECT_EQ(view.cellSize(), ZOOM_LEVELS[0]);
+}
+
+TEST(BoardViewTest, FlatColoursFollowCellState)
+{
+	TableState state;
+	state.resetModel(2, 2, 0);
+
+	BoardView view;
+	view.setModel(&state);
+
+	EXPECT_EQ(view.flatColorAt(0, 0), flatColor(CellSprite::Raised));
+	state.getMineSweeper().discover(0, 0);
+	EXPECT_EQ(view.flatColorAt(0, 0), flatColor(CellSprite::Sunken));
+	EXPECT_NE(flatColor(CellSprite::Raised), flatColor(CellSprite::Sunken));
+}
+
+TEST(BoardViewTest, LargeBoardGeometryIsBoundedByScreen)
+{
+	TableState state;
+	state.resetModel(500, 500, 100);
+
+	BoardView view;
+	view.setModel(&state);
+	view.adjustSizeToContents();
+
+	const QSize available = view.screen()->availableGeometry().size();
+	EXPECT_TRUE(view.needsScrolling());
+	EXPECT_LE(view.width(), available.width());
+	EXPECT_LE(view.height(), available.height());
+}
+
+TEST(BoardViewTest, InputBurstIsAppliedInOneBatch)
+{
+	TableState state;
+	state.resetModel(4, 6, 1);
+
+	BoardView view;
+	view.setModel(&state);
+	view.adjustSizeToContents();
+	QObject::connect(&view, &BoardView::rightClicked, &state, &TableState::onRightClicked);
+
+	QSignalSpy flags(&view, &BoardView::rightClicked);
+	QSignalSpy changes(&state, &TableState::dataChanged);
+
+	QTest::mouseClick(view.viewport(), Qt::RightButton, Qt::NoModifier, QPoint(1, 1));
+	QTest::mouseClick(view.viewport(), Qt::RightButton, Qt::NoModifier, QPoint(FIELD_SIZE * 2 + 1, FIELD_SIZE + 1));
+	EXPECT_EQ(flags.count(), 0);	// queued until the event loop turns
+
+	QCoreApplication::processEvents();
+	ASSERT_EQ(flags.count(), 2);
+	EXPECT_EQ(flags[0][0].value< QModelIndex >(), state.index(0, 0));	  // order is kept
+	EXPECT_EQ(flags[1][0].value< QModelIndex >(), state.index(1, 2));
+
+	ASSERT_EQ(changes.count(), 1);
+	EXPECT_EQ(changes[0][0].value< QModelIndex >(), state.index(0, 0));
+	EXPECT_EQ(changes[0][1].value< QModelIndex >(), state.index(1, 2));
+}
+
+TEST_F(TableStateTest, ChangesOutsideBatchStaySynchronous)
+{
+	TableState& state = *tableState;
+	state.resetModel(5, 5, 1);
+	QSignalSpy changes(&state, &TableState::dataChanged);
+
+	state.onRightClicked(state.index(0, 0));
+	EXPECT_EQ(changes.count(), 1);
+
+	state.beginBatch();
+	state.onRightClicked(state.index(4, 4));
+	state.beginBatch();
+	state.onRightClicked(state.index(2, 1));
+	state.endBatch();
+	EXPECT_EQ(changes.count(), 1);	  // nested batches flush with the outer one
+	state.endBatch();
+
+	ASSERT_EQ(changes.count(), 2);
+	EXPECT_EQ(changes[1][0].value< QModelIndex >(), state.index(2, 1));
+	EXPECT_EQ(changes[1][1].value< QModelIndex >(), state.index(4, 4));
+}
+
+TEST_F(TableStateTest, ResetForgetsTheHighlight)
+{
+	TableState& state = *tableState;
+	state.resetModel(10, 10, 1);
+	state.m_highlighted = QRect(7, 7, 3, 3);	// as a middle click near the corner leaves it
+	state.resetModel(4, 4, 1);
+
+	QSignalSpy changes(&state, &TableState::dataChanged);
+	state.clearHighlight();	   // the timer firing late
+	EXPECT_EQ(changes.count(), 0);
+}
+
+TEST_F(TableStateTest, DistantChangesInBatchStaySeparate)
+{
+	TableState& state = *tableState;
+	state.resetModel(500, 500, 1);
+	QSignalSpy changes(&state, &TableState::dataChanged);
+
+	state.beginBatch();
+	state.onRightClicked(state.index(0, 0));
+	state.onRightClicked(state.index(499, 499));
+	state.onRightClicked(state.index(1, 1));	// next to the first, shares its rect
+	state.endBatch();
+
+	ASSERT_EQ(changes.count(), 2);
+	EXPECT_EQ(changes[0][0].value< QModelIndex >(), state.index(499, 499));
+	EXPECT_EQ(changes[0][1].value< QModelIndex >(), state.index(499, 499));
+	EXPECT_EQ(changes[1][0].value< QModelIndex >(), state.index(0, 0));
+	EXPECT_EQ(changes[1][1].value< QModelIndex >(), state.index(1, 1));
+}
+
+TEST_F(MineSweeperTest, ResetReusesBoardOfSameSize)
+{
+	game.field(1, 1).discovered = 1;
+	game.reset(5, 5, 3);
+	EXPECT_EQ(game.size(), 25);
+	EXPECT_FALSE(game.getDiscovered(1, 1));
+}
+
+TEST(FrameStatsTest, FramesLandInHistogram)
+{
+	FrameStats stats;
+	stats.addDataChanged(4);
+	stats.addDataChanged(6);
+	stats.beginFrame();
+	stats.endFrame(100);
+
+	const QVector< int > histogram = stats.paintHistogram();
+	ASSERT_EQ(histogram.size(), STATS_BUCKETS);
+	EXPECT_EQ(std::accumulate(histogram.begin(), histogram.end(), 0), 1);
+	EXPECT_TRUE(stats.summary().join(' ').contains("cells painted 100"));
+	EXPECT_TRUE(stats.summary().join(' ').contains("dataChanged 2 (10 cells)"));
+}
+
+TEST(FrameStatsTest, HistoryIsRolling)
+{
+	FrameStats stats;
+	for (int i = 0; i < STATS_HISTORY + 10; ++i)
+	{
+		stats.beginFrame();
+		stats.endFrame(1);
+	}
+
+	const QVector< int > histogram = stats.paintHistogram();
+	EXPECT_EQ(std::accumulate(histogram.begin(), histogram.end(), 0), STATS_HISTORY);
+}
+
+TEST(FrameStatsTest, DumpWritesHistogramFile)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("stats.csv");
+
+	FrameStats stats;
+	stats.beginFrame();
+	stats.endFrame(1);
+	ASSERT_TRUE(stats.dump(path));
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly | QIODevice::Text));
+	EXPECT_TRUE(file.readAll().contains("bucket_ms,paint_frames,loop_ticks"));
+}
+
+TEST(LatencyTrackerTest, SampleNeedsDataChangedBeforePaint)
+{
+	LatencyTracker latency;
+	latency.painted();
+	EXPECT_EQ(latency.sampleCount(), 0);
+
+	latency.begin();
+	latency.mark(LatencyTracker::Slot);
+	latency.painted();	  // e.g. the pressed-button repaint
+	EXPECT_EQ(latency.sampleCount(), 0);
+
+	latency.mark(LatencyTracker::Engine);
+	latency.mark(LatencyTracker::DataChanged);
+	latency.painted();
+	latency.painted();	  // later paints are not the first one
+	EXPECT_EQ(latency.sampleCount(), 1);
+
+	EXPECT_LE(latency.percentile(LatencyTracker::Slot, 0.5), latency.percentile(LatencyTracker::Engine, 0.5));
+	EXPECT_LE(latency.percentile(LatencyTracker::DataChanged, 0.5), latency.percentile(LatencyTracker::Painted, 0.5));
+	EXPECT_EQ(latency.summary().size(), 2);
+}
+
+TEST(LatencyTrackerTest, ModelMarksStagesAndLogIsWritten)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("logs/latency.log");
+
+	LatencyTracker latency;
+	ASSERT_TRUE(latency.setLogFile(path));
+
+	TableState model;
+	model.resetModel(6, 6, 2);
+	model.setLatencyTracker(&latency);
+
+	latency.begin();
+	model.onRightClicked(model.index(3, 3));
+	latency.painted();
+	ASSERT_EQ(latency.sampleCount(), 1);
+	EXPECT_GE(latency.percentile(LatencyTracker::Painted, 1.0), latency.percentile(LatencyTracker::DataChanged, 1.0));
+
+	latency.setLogFile(QString());
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadOnly | QIODevice::Text));
+	const QList< QByteArray > lines = file.readAll().split('\n');
+	ASSERT_GE(lines.size(), 2);
+	EXPECT_EQ(lines[0], "slot_us,engine_us,datachanged_us,paint_us");
+	EXPECT_EQ(lines[1].count(','), 3);
+}
+
+TEST(BoardRendererTest, ImageCoversWholeBoard)
+{
+	MineSweeper board;
+	board.reset(3, 4, 1);
+
+	BoardRenderer renderer(board, false, false);
+	QImage image = renderer.render();
+
+	EXPECT_EQ(image.size(), QSize(4 * FIELD_SIZE, 3 * FIELD_SIZE));
+	EXPECT_EQ(image.size(), renderer.imageSize());
+}
+
+TEST(BoardRendererTest, FlatRenderUsesSpriteColours)
+{
+	MineSweeper board;
+	board.reset(130, 130, 0);
+	board.discover(129, 129);
+
+	BoardRenderer renderer(board, false, false, 1);
+	QImage image = renderer.render();
+
+	ASSERT_EQ(image.size(), QSize(130, 130));
+	EXPECT_EQ(image.pixel(0, 0), flatColor(CellSprite::Raised));
+	EXPECT_EQ(image.pixel(129, 129), flatColor(CellSprite::Sunken));
+}
+
+TEST(BoardRendererTest, TilesMatchSingleThreadedRender)
+{
+	MineSweeper board;
+	board.reset(70, 70, 200);
+	board.populate(0, 0);
+	board.discover(0, 0);
+	board.disarm(69, 69);
+
+	BoardRenderer renderer(board, true, false);
+	QImage parallel = renderer.render();
+
+	QImage serial(renderer.imageSize(), QImage::Format_ARGB32_Premultiplied);
+	renderer.renderCells(serial, QRect(0, 0, 70, 70), QPoint(0, 0));
+
+	EXPECT_EQ(parallel, serial);
+}
+
+TEST(BoardRendererTest, BandedPngExportDecodesToSameImage)
+{
+	MineSweeper board;
+	board.reset(50, 30, 100);
+	board.populate(0, 0);
+	board.discover(0, 0);
+	board.disarm(49, 29);
+
+	BoardRenderer renderer(board, true, false, 2);
+
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	// Room for three cell rows per band, so the last band is partial
+	ASSERT_TRUE(renderer.exportPng(&buffer, 3 * 30 * 2 * 4 * 2));
+
+	QImage decoded = QImage::fromData(buffer.data(), "PNG");
+	ASSERT_FALSE(decoded.isNull());
+	EXPECT_EQ(decoded.size(), renderer.imageSize());
+	EXPECT_EQ(decoded.convertToFormat(QImage::Format_RGB32), renderer.render().convertToFormat(QImage::Format_RGB32));
+}
+
+TEST(PngWriterTest, RejectsRowsBeyondDeclaredHeight)
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+
+	PngWriter writer(&buffer);
+	ASSERT_TRUE(writer.begin(4, 2));
+
+	QImage rows(4, 2, QImage::Format_ARGB32_Premultiplied);
+	rows.fill(Qt::red);
+	EXPECT_FALSE(writer.finish());
+	EXPECT_TRUE(writer.writeRows(rows));
+	EXPECT_FALSE(writer.writeRows(rows));
+	EXPECT_EQ(writer.rowsWritten(), 2);
+	EXPECT_TRUE(writer.finish());
+
+	QImage decoded = QImage::fromData(buffer.data(), "PNG");
+	ASSERT_EQ(decoded.size(), QSize(4, 2));
+	EXPECT_EQ(decoded.pixel(3, 1), qRgb(255, 0, 0));
+}
+
+TEST(ReplayTest, ApplyMoveFollowsTableStateRules)
+{
+	MineSweeper board;
+	board.reset(5, 5, 0);
+	board.populate(0, 0);
+
+	Move flag{ Move::Flag, 2, 2, 0 };
+	EXPECT_EQ(board.applyMove(flag), QRect(2, 2, 1, 1));
+	EXPECT_EQ(board.getFlag(2, 2), FIELD_VISITED);
+
+	Move reveal{ Move::Reveal, 2, 2, 10 };
+	EXPECT_TRUE(board.applyMove(reveal).isNull());	  // flagged cells do not open
+
+	reveal.row = 0;
+	reveal.column = 0;
+	EXPECT_EQ(board.applyMove(reveal), QRect(0, 0, 5, 5));
+	EXPECT_FALSE(board.getDiscovered(2, 2));
+	EXPECT_FALSE(board.hasPendingReveal());
+}
+
+TEST(ReplayTest, RecorderStartsWithGameAndStoresClicks)
+{
+	TableState model;
+	model.resetModel(5, 5, 3);
+	BoardView view;
+	view.setModel(&model);
+	QObject::connect(&view, &BoardView::clicked, &model, &TableState::onTableClicked);
+	QObject::connect(&view, &BoardView::rightClicked, &model, &TableState::onRightClicked);
+
+	ReplayRecorder recorder;
+	recorder.attach(&view, &model);
+
+	emit view.rightClicked(model.index(4, 4));	  // before the game starts
+	EXPECT_FALSE(recorder.isRecording());
+
+	emit view.clicked(model.index(1, 2));
+	ASSERT_TRUE(recorder.isRecording());
+	ASSERT_EQ(recorder.moves().size(), 1);
+	EXPECT_EQ(recorder.moves()[0].type, Move::Reveal);
+	EXPECT_EQ(recorder.moves()[0].row, 1);
+	EXPECT_EQ(recorder.moves()[0].column, 2);
+	EXPECT_EQ(recorder.startBoard().totalMineNr(), 3);
+	EXPECT_FALSE(recorder.startBoard().getDiscovered(1, 2));
+	EXPECT_EQ(recorder.startBoard().getFlag(4, 4), FIELD_VISITED);
+
+	recorder.clear();
+	EXPECT_FALSE(recorder.isRecording());
+	EXPECT_TRUE(recorder.moves().isEmpty());
+}
+
+TEST(ReplayTest, LastFrameMatchesFullRender)
+{
+	MineSweeper start;
+	start.reset(12, 9, 10);
+	start.populate(0, 0);
+
+	QVector< Move > moves;
+	moves.append(Move{ Move::Reveal, 0, 0, 0 });
+	moves.append(Move{ Move::Flag, 11, 8, 500 });
+	moves.append(Move{ Move::Reveal, 6, 4, 5000 });
+
+	MineSweeper finish = start;
+	for (const Move &move : moves)
+	{
+		finish.applyMove(move);
+	}
+
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	ReplayRenderer replay(start, moves, false, 8);
+	ASSERT_EQ(replay.frameCount(), 4);
+	ASSERT_TRUE(replay.renderTo(dir.path()));
+
+	for (int frame = 0; frame < replay.frameCount(); ++frame)
+	{
+		EXPECT_TRUE(QFile::exists(dir.filePath(ReplayRenderer::frameName(frame))));
+	}
+	EXPECT_TRUE(QFile::exists(dir.filePath("replay.ffconcat")));
+
+	const bool over = finish.mineRevealed() || finish.checkWinCondition();
+	QImage expected = BoardRenderer(finish, over, false, 8).render();
+	QImage last(dir.filePath(ReplayRenderer::frameName(3)));
+	EXPECT_EQ(last.convertToFormat(QImage::Format_ARGB32_Premultiplied), expected);
+}
+
+TEST(MoveJournalTest, ReplaysMovesAfterCheckpoint)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	const QString path = dir.filePath("test.journal");
+
+	MineSweeper board;
+	board.reset(6, 6, 0);
+	board.populate(0, 0);
+
+	MineSweeper checkpoint;
+	qint64 covered = 0;
+	{
+		MoveJournal journal(path);
+		ASSERT_TRUE(journal.restart());
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 5, 5, 0 }));
+		board.applyMove(Move{ Move::Flag, 5, 5, 0 });
+
+		covered = journal.beginCheckpoint();
+		checkpoint = board;
+		journal.endCheckpoint(true);
+
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 1, 1, 10 }));
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 1, 1, 20 }));	  // flag then question mark
+		ASSERT_TRUE(journal.append(Move{ Move::Reveal, 0, 0, 30 }));
+	}	 // as if the process died here
+
+	MoveJournal recovered(path);
+	EXPECT_EQ(recovered.replay(checkpoint, covered), 3);
+	EXPECT_EQ(recovered.sequence(), covered + 3);
+	EXPECT_EQ(checkpoint.getFlag(5, 5), FIELD_VISITED);
+	EXPECT_EQ(checkpoint.fieldConst(1, 1).disarmed, 2);
+	EXPECT_TRUE(checkpoint.getDiscovered(0, 0));
+	EXPECT_FALSE(checkpoint.getDiscovered(5, 5));
+}
+
+TEST(MoveJournalTest, ReplayOntoNewerCellsKeepsFlags)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	const QString path = dir.filePath("test.journal");
+
+	qint64 covered = 0;
+	{
+		MoveJournal journal(path);
+		ASSERT_TRUE(journal.restart());
+		covered = journal.beginCheckpoint();
+		journal.endCheckpoint(true);
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 1, 1, 10 }, FIELD_VISITED));
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 1, 1, 20 }, PLAYER_NOT_SURE));
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 2, 2, 30 }, FIELD_VISITED));
+	}
+
+	// The session's cells reached the disk with both moves, its header without them
+	MineSweeper newer;
+	newer.reset(4, 4, 0);
+	newer.field(1, 1).disarmed = PLAYER_NOT_SURE;
+	newer.field(2, 2).disarmed = FIELD_VISITED;
+	EXPECT_EQ(MoveJournal(path).replay(newer, covered), 3);
+	EXPECT_EQ(newer.fieldConst(1, 1).disarmed, PLAYER_NOT_SURE);
+	EXPECT_EQ(newer.fieldConst(2, 2).disarmed, FIELD_VISITED);
+
+	MineSweeper older;
+	older.reset(4, 4, 0);
+	EXPECT_EQ(MoveJournal(path).replay(older, covered), 3);
+	EXPECT_EQ(older.fieldConst(1, 1).disarmed, PLAYER_NOT_SURE);
+	EXPECT_EQ(older.fieldConst(2, 2).disarmed, FIELD_VISITED);
+}
+
+TEST(MoveJournalTest, TornTailIsDropped)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	const QString path = dir.filePath("test.journal");
+
+	qint64 covered = 0;
+	{
+		MoveJournal journal(path);
+		ASSERT_TRUE(journal.restart());
+		covered = journal.beginCheckpoint();
+		journal.endCheckpoint(true);
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 0, 0, 0 }));
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 2, 2, 0 }));
+	}
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+	ASSERT_TRUE(file.resize(file.size() - 3));
+	file.close();
+
+	MineSweeper board;
+	board.reset(4, 4, 0);
+	MoveJournal recovered(path);
+	EXPECT_EQ(recovered.replay(board, covered), 1);
+	EXPECT_EQ(board.getFlag(0, 0), FIELD_VISITED);
+	EXPECT_EQ(board.getFlag(2, 2), 0);
+
+	// The torn record is cut off, so new moves follow the last good one
+	ASSERT_TRUE(recovered.append(Move{ Move::Flag, 3, 3, 0 }));
+	MineSweeper again;
+	again.reset(4, 4, 0);
+	EXPECT_EQ(MoveJournal(path).replay(again, covered), 2);
+	EXPECT_EQ(again.getFlag(3, 3), FIELD_VISITED);
+}
+
+TEST(MoveJournalTest, JournalOfNewerGameIsNotReplayed)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	const QString path = dir.filePath("test.journal");
+
+	qint64 oldCheckpoint = 0;
+	{
+		MoveJournal journal(path);
+		ASSERT_TRUE(journal.restart());
+		oldCheckpoint = journal.beginCheckpoint();
+		journal.endCheckpoint(true);
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 0, 0, 0 }));
+
+		ASSERT_TRUE(journal.restart());	   // new game, its checkpoint never lands
+		ASSERT_TRUE(journal.append(Move{ Move::Flag, 1, 1, 0 }));
+	}
+
+	MineSweeper board;
+	board.reset(3, 3, 0);
+	EXPECT_EQ(MoveJournal(path).replay(board, oldCheckpoint), 0);
+	EXPECT_EQ(board.getFlag(0, 0), 0);
+	EXPECT_EQ(board.getFlag(1, 1), 0);
+}
+
+TEST_F(TableStateTest, ResumeLoadedPicksUpBoardState)
+{
+	tableState->resetModel(5, 5, 2);
+	MineSweeper &board = tableState->getMineSweeper();
+	board.populate(0, 0);
+	board.disarm(4, 4);
+	board.discover(0, 0);
+
+	QSignalSpy mineSpy(tableState, &TableState::mineDisplay);
+	tableState->resumeLoaded();
+
+	EXPECT_TRUE(tableState->m_initialized);
+	ASSERT_EQ(mineSpy.count(), 1);
+	EXPECT_EQ(mineSpy.takeFirst().at(0).toInt(), 1);
+}
+
+TEST(BoardIOTest, TextGridParsesMinesAndOpenCells)
+{
+	const QByteArray text = "*..\r\n.2*\r\n...";	// CRLF, no break after the last row
+	MineSweeper board;
+	QString error;
+	ASSERT_TRUE(BoardIO::parseText(text.constData(), text.size(), board, &error)) << error.toStdString();
+	EXPECT_EQ(board.width(), 3);
+	EXPECT_EQ(board.height(), 3);
+	EXPECT_EQ(board.totalMineNr(), 2);
+	EXPECT_EQ(board.getMine(0, 0), 1);
+	EXPECT_EQ(board.getMine(2, 1), 1);
+	EXPECT_TRUE(board.getDiscovered(1, 1));
+	EXPECT_EQ(board.getNeighbours(1, 1), 2);
+	EXPECT_EQ(board.discoveredCount(), 1);
+
+	const QByteArray ragged = "*..\n..\n";
+	EXPECT_FALSE(BoardIO::parseText(ragged.constData(), ragged.size(), board, &error));
+	const QByteArray stray = "*.x\n...\n";
+	EXPECT_FALSE(BoardIO::parseText(stray.constData(), stray.size(), board, &error));
+	EXPECT_TRUE(error.contains("line 1"));
+}
+
+TEST(BoardIOTest, TextFileRoundTripsThroughMapping)
+{
+	MineSweeper game;
+	game.reset(1500, 700, 90000);
+	game.populate(0, 0);
+	game.discover(0, 0);
+
+	QTemporaryDir dir;
+	const QString path = dir.filePath("board.txt");
+	ASSERT_TRUE(BoardIO::write(path, game));
+	EXPECT_EQ(QFileInfo(path).size(), qint64(1501) * 700);
+
+	MineSweeper loaded;
+	QString error;
+	ASSERT_TRUE(BoardIO::read(path, loaded, &error)) << error.toStdString();
+	ASSERT_EQ(loaded.size(), game.size());
+	EXPECT_EQ(loaded.totalMineNr(), game.totalMineNr());
+	EXPECT_EQ(loaded.discoveredCount(), game.discoveredCount());
+	for (long long i = 0; i < game.size(); ++i)
+	{
+		ASSERT_EQ(loaded.cells()[i].mine, game.cells()[i].mine);
+		ASSERT_EQ(loaded.cells()[i].discovered, game.cells()[i].discovered);
+		ASSERT_EQ(loaded.cells()[i].neighbours, game.cells()[i].neighbours);
+	}
+}
+
+TEST(BoardIOTest, MbfRoundTripAndLimits)
+{
+	MineSweeper game;
+	game.reset(30, 16, 99);
+	game.populate(5, 5);
+
+	QBuffer buffer;
+	buffer.open(QIODevice::ReadWrite);
+	ASSERT_TRUE(BoardIO::writeMbf(&buffer, game));
+	EXPECT_EQ(buffer.size(), 4 + 99 * 2);
+
+	buffer.seek(0);
+	MineSweeper loaded;
+	ASSERT_TRUE(BoardIO::readMbf(&buffer, loaded));
+	EXPECT_EQ(loaded.width(), 30);
+	EXPECT_EQ(loaded.height(), 16);
+	EXPECT_EQ(loaded.totalMineNr(), 99);
+	for (long long i = 0; i < game.size(); ++i)
+	{
+		ASSERT_EQ(loaded.cells()[i].mine, game.cells()[i].mine);
+		ASSERT_EQ(loaded.cells()[i].neighbours, game.cells()[i].neighbours);
+	}
+
+	MineSweeper wide;
+	wide.reset(300, 10, 1);
+	QBuffer other;
+	other.open(QIODevice::WriteOnly);
+	QString error;
+	EXPECT_FALSE(BoardIO::writeMbf(&other, wide, &error));
+	EXPECT_FALSE(error.isEmpty());
+}
+
+TEST(BoardCorpusTest, ThreeBVCountsOpeningsAndIsolatedNumbers)
+{
+	// Mines at the two right-hand corners of a 5x3 board: the left three columns are one
+	// opening that reaches column 3, but not (4, 1) between the mines
+	MineSweeper board;
+	board.reset(5, 3, 0);
+	board.field(4, 0).mine = 1;
+	board.field(4, 2).mine = 1;
+	board.recountMines();
+	EXPECT_EQ(board.threeBV(), 2);	  // the opening, plus (4, 1) which only touches numbers
+
+	MineSweeper dense;
+	dense.reset(3, 1, 0);
+	dense.field(1, 0).mine = 1;
+	dense.recountMines();
+	EXPECT_EQ(dense.threeBV(), 2);	  // no openings, two numbered cells
+}
+
+TEST(BoardCorpusTest, BoardsLoadByIndexFromTheMappedFile)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("boards.dsbc");
+
+	QVector< MineSweeper > boards;
+	BoardCorpusWriter writer(path);
+	ASSERT_TRUE(writer.open());
+	for (int i = 0; i < 50; ++i)
+	{
+		MineSweeper board;
+		board.reset(i % 2 ? 30 : 9, i % 2 ? 16 : 9, i % 2 ? 99 : 10);
+		board.populate(i % 9, i % 7);
+		ASSERT_TRUE(writer.append(board));
+		boards.append(board);
+	}
+	ASSERT_TRUE(writer.commit());
+
+	BoardCorpus corpus;
+	QString error;
+	ASSERT_TRUE(corpus.open(path, &error)) << error.toStdString();
+	ASSERT_EQ(corpus.count(), 50);
+	EXPECT_EQ(corpus.header(50), nullptr);
+
+	for (int i : { 49, 0, 17 })
+	{
+		const BoardCorpus::BoardHeader *header = corpus.header(i);
+		ASSERT_NE(header, nullptr);
+		EXPECT_EQ(int(header->width), boards[i].width());
+		EXPECT_EQ(quint32(header->seed), boards[i].seed());
+		EXPECT_EQ(int(header->threeBV), boards[i].threeBV());
+		EXPECT_EQ(int(header->firstX), i % 9);
+		EXPECT_EQ(header->difficulty, i % 2 ? BoardCorpus::Expert : BoardCorpus::Beginner);
+
+		MineSweeper loaded;
+		ASSERT_TRUE(corpus.load(i, loaded));
+		ASSERT_EQ(loaded.size(), boards[i].size());
+		EXPECT_EQ(loaded.seed(), boards[i].seed());
+		EXPECT_TRUE(loaded.isGenerated());
+		EXPECT_EQ(loaded.firstClick(), boards[i].firstClick());
+		for (long long c = 0; c < loaded.size(); ++c)
+		{
+			ASSERT_EQ(loaded.cells()[c].mine, boards[i].cells()[c].mine);
+			ASSERT_EQ(loaded.cells()[c].neighbours, boards[i].cells()[c].neighbours);
+		}
+	}
+
+	QFile truncated(dir.filePath("short.dsbc"));
+	ASSERT_TRUE(truncated.open(QIODevice::WriteOnly));
+	QFile full(path);
+	ASSERT_TRUE(full.open(QIODevice::ReadOnly));
+	truncated.write(full.read(full.size() / 2));
+	truncated.close();
+	EXPECT_FALSE(corpus.open(truncated.fileName()));
+}
+
+TEST(BoardCorpusTest, BadEntryLeavesTheBoardAlone)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("boards.dsbc");
+
+	MineSweeper claimsMines;
+	claimsMines.reset(9, 9, 10);	// header says 10, no mine was ever placed
+	BoardCorpusWriter writer(path);
+	ASSERT_TRUE(writer.open());
+	ASSERT_TRUE(writer.append(claimsMines));
+	ASSERT_TRUE(writer.commit());
+
+	BoardCorpus corpus;
+	ASSERT_TRUE(corpus.open(path));
+	MineSweeper board;
+	board.reset(16, 16, 40);
+	board.populate(3, 3);
+	const quint32 seed = board.seed();
+	EXPECT_FALSE(corpus.load(0, board));
+	EXPECT_EQ(board.width(), 16);
+	EXPECT_EQ(board.totalMineNr(), 40);
+	EXPECT_EQ(board.seed(), seed);
+}
+
+TEST(SaveIndexTest, ScansOnlyChangedSavesAndKeepsTheIndexOnDisk)
+{
+	QTemporaryDir dir;
+	auto writeSave = [&](const QString &name, int width, int height, int mines)
+	{
+		MineSweeper board;
+		board.reset(width, height, mines);
+		board.populate(0, 0);
+		board.discover(0, 0);
+		QFile file(dir.filePath(name));
+		return file.open(QIODevice::WriteOnly) && SaveFormat::write(&file, board, 12, false);
+	};
+	ASSERT_TRUE(writeSave("a.sav", 20, 10, 30));
+	ASSERT_TRUE(writeSave("b.sav", 8, 8, 10));
+	QFile junk(dir.filePath("c.sav"));
+	ASSERT_TRUE(junk.open(QIODevice::WriteOnly));
+	junk.write("not a save");
+	junk.close();
+
+	{
+		SaveIndex index(dir.path());
+		EXPECT_TRUE(index.entries().isEmpty());
+		index.refresh();
+		index.waitForRefresh();
+
+		const QVector< SaveIndex::Entry > entries = index.entries();
+		ASSERT_EQ(entries.size(), 3);
+		EXPECT_EQ(entries[0].fileName, "a.sav");
+		EXPECT_TRUE(entries[0].readable);
+		EXPECT_EQ(entries[0].header.width, 20);
+		EXPECT_EQ(entries[0].header.mines, 30);
+		EXPECT_EQ(entries[0].header.elapsed, 12);
+		EXPECT_EQ(entries[0].header.state, SaveFormat::InProgress);
+		EXPECT_EQ(entries[0].thumbnail.size(), QSize(10, 20));	  // rows are the board's x
+		EXPECT_FALSE(entries[2].readable);
+		EXPECT_TRUE(QFile::exists(index.indexPath()));
+	}
+
+	// Same size and time stamp as before: taken from the index, the save is not parsed
+	QFile save(dir.filePath("b.sav"));
+	const QDateTime modified = QFileInfo(save).lastModified();
+	ASSERT_TRUE(save.open(QIODevice::ReadWrite));
+	save.write(QByteArray(int(save.size()), '\0'));
+	ASSERT_TRUE(save.setFileTime(modified, QFileDevice::FileModificationTime));
+	save.close();
+	ASSERT_TRUE(writeSave("a.sav", 30, 16, 99));
+
+	SaveIndex index(dir.path());
+	ASSERT_EQ(index.entries().size(), 3);	 // read back from the index file
+	index.refresh();
+	index.waitForRefresh();
+
+	const QVector< SaveIndex::Entry > entries = index.entries();
+	ASSERT_EQ(entries.size(), 3);
+	EXPECT_EQ(entries[0].header.width, 30);
+	EXPECT_EQ(entries[0].header.mines, 99);
+	EXPECT_TRUE(entries[1].readable);
+	EXPECT_EQ(entries[1].header.width, 8);
+	EXPECT_FALSE(entries[1].thumbnail.isNull());
+}
+
+TEST(SessionFileTest, SyncCopiesOnlyMarkedCellsInPlace)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("session.dat");
+
+	MineSweeper game;
+	game.reset(40, 25, 100);
+	game.populate(3, 4);
+	game.discover(3, 4);
+
+	SessionFile session(path);
+	ASSERT_TRUE(session.sync(game, 9, true, 17));
+	EXPECT_EQ(QFileInfo(path).size(), qint64(sizeof(SessionFile::Header)) + game.size() * qint64(sizeof(GameField)));
+
+	game.disarm(10, 20);	// marked below
+	game.disarm(30, 2);		// not marked, so not copied
+	session.markChanged(QRect(10, 20, 1, 1));
+	ASSERT_TRUE(session.sync(game, 11, false, 18));
+	session.syncTime(12, false);
+	session.flush();
+
+	MineSweeper loaded;
+	SaveHeader header;
+	ASSERT_TRUE(SessionFile::load(path, loaded, header));
+	EXPECT_EQ(header.width, 40);
+	EXPECT_EQ(header.height, 25);
+	EXPECT_EQ(header.mines, 100);
+	EXPECT_EQ(header.elapsed, 12);
+	EXPECT_FALSE(header.timerRunning);
+	EXPECT_EQ(header.journalSequence, 18);
+	EXPECT_EQ(header.state, SaveFormat::InProgress);
+	EXPECT_EQ(loaded.seed(), game.seed());
+	EXPECT_EQ(loaded.discoveredCount(), 1);
+	EXPECT_EQ(loaded.fieldConst(10, 20).disarmed, 1);
+	EXPECT_EQ(loaded.fieldConst(30, 2).disarmed, 0);
+	for (long long i = 0; i < game.size(); ++i)
+	{
+		ASSERT_EQ(loaded.cells()[i].mine, game.cells()[i].mine);
+		ASSERT_EQ(loaded.cells()[i].neighbours, game.cells()[i].neighbours);
+	}
+
+	// A new board of another size remaps the file and copies everything
+	game.reset(8, 8, 10);
+	game.populate(0, 0);
+	ASSERT_TRUE(session.sync(game, 0, false, 30));
+	QSignalSpy flushed(&session, &SessionFile::flushed);
+	session.flushDurably();
+	EXPECT_EQ(flushed.count(), 0);	  // reported from the event loop
+	ASSERT_TRUE(flushed.wait());
+	EXPECT_TRUE(flushed[0][0].toBool());
+	session.close();
+	session.flushDurably();
+	ASSERT_TRUE(flushed.wait());
+	EXPECT_FALSE(flushed[1][0].toBool());	 // nothing mapped
+	ASSERT_TRUE(Save::readHeader(path, header));
+	EXPECT_EQ(header.width, 8);
+	EXPECT_EQ(header.journalSequence, 30);
+
+	QFile::resize(path, QFileInfo(path).size() - 1);
+	EXPECT_FALSE(SessionFile::load(path, loaded, header));
+}
+
+TEST(SessionFileTest, FirstClickAfterFlagSyncsTheMines)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("session.dat");
+
+	MineSweeper game;
+	game.reset(20, 20, 40);
+	SessionFile session(path);
+	ASSERT_TRUE(session.sync(game, 0, false, 0));
+
+	game.disarm(10, 10);	// flagged before the first click
+	session.markChanged(QRect(10, 10, 1, 1));
+	ASSERT_TRUE(session.sync(game, 0, false, 1));
+
+	game.populate(0, 0);
+	game.discover(0, 0);
+	session.markChanged(QRect(0, 0, 1, 1));	   // only the clicked cell, as a dataChanged would
+	ASSERT_TRUE(session.sync(game, 0, true, 2));
+	session.close();
+
+	MineSweeper loaded;
+	SaveHeader header;
+	ASSERT_TRUE(SessionFile::load(path, loaded, header));
+	EXPECT_EQ(loaded.totalMineNr(), 40);
+	EXPECT_EQ(loaded.fieldConst(10, 10).disarmed, game.fieldConst(10, 10).disarmed);
+	for (long long i = 0; i < game.size(); ++i)
+	{
+		ASSERT_EQ(loaded.cells()[i].mine, game.cells()[i].mine);
+	}
+}
+
+TEST(SessionFileTest, DamagedCellsAreNotLoaded)
+{
+	QTemporaryDir dir;
+	const QString path = dir.filePath("session.dat");
+
+	MineSweeper game;
+	game.reset(6, 6, 5);
+	game.populate(0, 0);
+	game.field(2, 2).isHighlighted = true;
+	{
+		SessionFile session(path);
+		ASSERT_TRUE(session.sync(game, 0, false, 0));
+	}
+
+	MineSweeper loaded;
+	SaveHeader header;
+	ASSERT_TRUE(SessionFile::load(path, loaded, header));
+	EXPECT_FALSE(loaded.fieldConst(2, 2).isHighlighted);
+
+	QFile file(path);
+	ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+	ASSERT_TRUE(file.seek(sizeof(SessionFile::Header) + 7 * sizeof(GameField) + offsetof(GameField, neighbours)));
+	file.putChar(char(40));
+	file.close();
+	EXPECT_FALSE(SessionFile::load(path, loaded, header));
+}
+
 int main(int argc, char** argv)
 {
 	QApplication app(argc, argv);	 // Обязательно для работы с QWidget